@@ -8,6 +8,7 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
+#include <limits>
 #include <string>
 
 #include "tlx/cmdline_parser.hpp"
@@ -22,80 +23,157 @@
 #include "tree/patricia_trie_pointer.hpp"
 #include "util/uint_types.hpp"
 
-int32_t main(int32_t argc, char const* argv[]) {
-  dpt::mpi::environment env;
-  tlx::CmdlineParser cp;
-
-  cp.set_description("dpt: Distributed Patricia Tries");
-  cp.set_author("Florian Kurpicz <florian.kurpicz@tu-dortmund.de>");
-
+struct benchmark_config {
+  std::string text_file;
   std::string sa_file;
-  cp.add_param_string("sa_file", sa_file, "The suffix array.");
   std::string lcp_file;
-  cp.add_param_string("lcp_file", lcp_file, "The LCP array.");
-  std::string text_file;
-  cp.add_param_string("text_file", text_file, "The input text.");
+  std::string save_index;
+  std::string load_index;
   std::string query_file;
-  cp.add_string('q',"queries", query_file, "The queries.");
   uint32_t number_queries = 0;
-  cp.add_unsigned('n', "number_of_queries_per_pe", "N", number_queries,
-                  "Initially have batches of size N queries at each PE.");
-  std::string query_type("ex");
-  cp.add_string('t', "query_type", query_type, "The type of query:\n"
-                "[ex]istential queries (default), [co]unting queries, or "
-                "[en]umeration queries.");
-
-  if (!cp.process(argc, argv)) {
-    return -1;
-  }
+  std::string query_type = "ex";
+  uint32_t nr_threads = 1;
+  uint32_t limit = 0;
+  uint32_t cache_capacity = 0;
+  uint32_t repetitions = 1;
+}; // struct benchmark_config
 
-  auto local_text = dpt::mpi::distribute_file<uint8_t, dpt::uint40,
-                                              uint32_t>(text_file.c_str(), 40);
-  dpt::com::manager<uint8_t, dpt::uint40, uint32_t> com_manager(std::move(local_text));
-  auto local_sa = dpt::mpi::distribute_file<dpt::uint40, dpt::uint40,
-                                            uint32_t>(sa_file.c_str(), 0);
-  auto local_lcp = dpt::mpi::distribute_file<dpt::uint40, dpt::uint40,
-                                             uint32_t>(lcp_file.c_str(), 0);
-  
-  dpt::tree::distributed_patricia_trie<uint8_t, dpt::uint40, uint32_t,
-                                       dpt::tree::compact_trie_pointer,
-                                       dpt::tree::patricia_trie_pointer> dpt(text_file.c_str(),
-                                                                             sa_file.c_str(),
-                                                                             lcp_file.c_str(), 30);
+template <template <typename, typename, typename> class CompactTrieStructure,
+          template <typename, typename, typename> class PatriciaTrieStructure>
+int32_t run_benchmark(const benchmark_config& config,
+  dpt::mpi::environment& env) {
+  using dp_trie = dpt::tree::distributed_patricia_trie<uint8_t, dpt::uint40,
+    uint32_t, CompactTrieStructure, PatriciaTrieStructure>;
+  dp_trie dpt;
 
   auto start_time = MPI_Wtime();
-  dpt.construct<dpt::com::collective_communication, dpt::com::collective_communication>();
+  if (config.load_index.empty()) {
+    dpt = dp_trie(config.text_file, config.sa_file, config.lcp_file, 30);
+    dpt.template construct<dpt::com::collective_communication,
+                           dpt::com::collective_communication>(
+                             config.nr_threads);
+  } else if (!dpt.load(config.load_index)) {
+    if (env.rank() == 0) {
+      std::cout << "Could not load index " << config.load_index << std::endl;
+    }
+    return -1;
+  }
   auto end_time = MPI_Wtime();
   if (env.rank() == 0) {
-    std::cout << "CONSTRUCTION TIME: " << end_time - start_time << std::endl;
+    std::cout << (config.load_index.empty() ? "CONSTRUCTION TIME: " :
+                  "LOAD TIME: ") << end_time - start_time << std::endl;
+  }
+
+  if (!config.save_index.empty() && !dpt.save(config.save_index) &&
+    env.rank() == 0) {
+    std::cout << "Could not save index " << config.save_index << std::endl;
   }
 
-  if (query_file.size() > 0) {
-    if (number_queries == 0 && env.rank() == 0) {
+  if (config.query_file.size() > 0) {
+    if (config.number_queries == 0 && env.rank() == 0) {
       std::cout << "-n, --number_of_queries_per_pe is required." << std::endl;
       std::exit(-1);
     }
     auto query_text = dpt::mpi::distribute_linewise<uint8_t,
-                                                    dpt::uint40, uint32_t>(query_file, number_queries,
-                                                    30, 0, env);
+                                                    dpt::uint40, uint32_t>(
+      config.query_file, config.number_queries, 30, 0, env);
     dpt::query::query_list<uint8_t, dpt::uint40,
                            uint32_t> queries(std::move(query_text), 0, 30);
+    dpt.set_cache_capacity(config.cache_capacity);
     start_time = MPI_Wtime();
-    if (query_type.compare("co") == 0) {
-      dpt.counting_batched<dpt::com::collective_communication>(std::move(queries));
-    } else if (query_type.compare("en") == 0) {
-      dpt.enumeration_batched<dpt::com::collective_communication>(std::move(queries));
-    } else {
-      dpt.existential_batched<dpt::com::collective_communication>(std::move(queries));
+    for (uint32_t repetition = 0; repetition < config.repetitions;
+      ++repetition) {
+      auto batch = (repetition + 1 < config.repetitions) ? queries :
+        std::move(queries);
+      if (config.query_type.compare("co") == 0) {
+        dpt.template counting_batched<dpt::com::collective_communication>(
+          std::move(batch), config.nr_threads);
+      } else if (config.query_type.compare("en") == 0) {
+        dpt.template enumeration_batched<dpt::com::collective_communication>(
+          std::move(batch), config.nr_threads, (config.limit > 0) ?
+          size_t(config.limit) : std::numeric_limits<size_t>::max());
+      } else {
+        dpt.template existential_batched<dpt::com::collective_communication>(
+          std::move(batch), config.nr_threads);
+      }
     }
     end_time = MPI_Wtime();
     if (env.rank() == 0) {
       std::cout << "QUERY TIME: " << end_time - start_time << std::endl;
     }
+    if (config.cache_capacity > 0 && env.rank() == 0) {
+      const bool counting = (config.query_type.compare("co") == 0);
+      std::cout << "CACHE HITS: " << (counting ? dpt.counting_cache().hits() :
+                                      dpt.existential_cache().hits())
+                << " CACHE MISSES: "
+                << (counting ? dpt.counting_cache().misses() :
+                    dpt.existential_cache().misses()) << std::endl;
+    }
+  }
+  return 0;
+}
+
+int32_t main(int32_t argc, char const* argv[]) {
+  dpt::mpi::environment env;
+  tlx::CmdlineParser cp;
+  benchmark_config config;
+
+  cp.set_description("dpt: Distributed Patricia Tries");
+  cp.set_author("Florian Kurpicz <florian.kurpicz@tu-dortmund.de>");
+
+  cp.add_opt_param_string("text_file", config.text_file, "The input text.");
+  cp.add_string('s', "sa_file", config.sa_file, "The suffix array. If none "
+                "is given, the suffix array is computed during construction.");
+  cp.add_string('l', "lcp_file", config.lcp_file, "The LCP array. If none "
+                "is given, the LCP array is computed during construction.");
+  cp.add_string('w', "save_index", config.save_index, "Write the "
+                "constructed index to the given path (one file per PE).");
+  cp.add_string('i', "load_index", config.load_index, "Load the index from "
+                "the given path instead of constructing it.");
+  cp.add_string('q',"queries", config.query_file, "The queries.");
+  cp.add_unsigned('n', "number_of_queries_per_pe", "N", config.number_queries,
+                  "Initially have batches of size N queries at each PE.");
+  cp.add_string('t', "query_type", config.query_type, "The type of "
+                "query:\n[ex]istential queries (default), [co]unting "
+                "queries, or [en]umeration queries.");
+  cp.add_unsigned('j', "threads", "J", config.nr_threads,
+                  "Use J threads per PE to construct the local trie and to "
+                  "answer queries.");
+  cp.add_unsigned('k', "limit", "K", config.limit,
+                  "Report at most K occurrences per enumeration query "
+                  "(0 reports all occurrences).");
+  cp.add_unsigned('c', "cache_capacity", "C", config.cache_capacity,
+                  "Cache the results of C existential and counting queries "
+                  "per PE (default 0, i.e., no caching).");
+  cp.add_unsigned('r', "repetitions", "R", config.repetitions,
+                  "Answer the batch of queries R times.");
+  std::string node_layout("packed");
+  cp.add_string('o', "node_layout", node_layout, "The layout of the nodes "
+                "of the tries:\n[packed] array of nodes (default) or [split] "
+                "one array per field of the nodes.");
+
+  if (!cp.process(argc, argv)) {
+    return -1;
+  }
+  if (config.text_file.empty() && config.load_index.empty()) {
+    if (env.rank() == 0) {
+      std::cout << "Either text_file or -i, --load_index is required."
+                << std::endl;
+    }
+    return -1;
+  }
+
+  int32_t result = 0;
+  if (node_layout.compare("split") == 0) {
+    result = run_benchmark<dpt::tree::compact_trie_pointer_split,
+      dpt::tree::patricia_trie_pointer_split>(config, env);
+  } else {
+    result = run_benchmark<dpt::tree::compact_trie_pointer,
+      dpt::tree::patricia_trie_pointer>(config, env);
   }
 
   env.finalize();
-  return 0;
+  return result;
 }
 
 /******************************************************************************/
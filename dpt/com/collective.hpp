@@ -17,6 +17,7 @@
 #include "util/named_structs.hpp"
 #include "util/partition.hpp"
 #include "mpi/all_to_all.hpp"
+#include "mpi/sparse_all_to_all.hpp"
 
 namespace dpt {
 namespace com {
@@ -35,6 +36,8 @@ class collective_communication {
   using query_list = dpt::query::query_list<Alphabet, GlobalIndex, LocalIndex>;
 
 public:
+  /// The text is accessed through the local partition (see \e manager).
+  static constexpr bool remote_memory_access = false;
 
   /// \param text_positions A vector of text positions.
   /// \param local_text The local (partition) of the data to distribute.
@@ -98,7 +101,7 @@ std::vector<Alphabet> collective_communication<Alphabet, GlobalIndex, LocalIndex
   std::vector<size_t> rec_req_counts;
   std::vector<size_t> rec_req_positions;
   std::tie(rec_req_counts, rec_req_positions) =
-    dpt::mpi::alltoallv_counts(normalized_req_pos, counts);
+    dpt::mpi::adaptive_alltoallv_counts(normalized_req_pos, counts);
 
   std::vector<Alphabet> response;
   response.reserve(rec_req_positions.size());
@@ -107,7 +110,7 @@ std::vector<Alphabet> collective_communication<Alphabet, GlobalIndex, LocalIndex
   }
   std::vector<size_t>().swap(rec_req_positions);
   std::vector<Alphabet> rec_characters =
-    dpt::mpi::alltoallv(response, rec_req_counts);
+    dpt::mpi::adaptive_alltoallv(response, rec_req_counts);
 
   start_pos[0] = 0;
   for (size_t i = 1; i < start_pos.size(); ++i) {
@@ -162,30 +165,23 @@ std::vector<Alphabet>
   std::vector<size_t> rec_req_counts;
   std::vector<pos_size_request> rec_req_positions;
   std::tie(rec_req_counts, rec_req_positions) =
-    dpt::mpi::alltoallv_counts(pos_size_requests, counts);
+    dpt::mpi::adaptive_alltoallv_counts(pos_size_requests, counts);
   // Prepare the responses for the received requests (i.e., allocate memory and
   // compute the displacements).
   std::vector<Alphabet> response;
   std::vector<size_t> response_sizes(local_text.text_environment().size(), 0);
-  size_t request_size = 0;
-  size_t target_pe = 0;
-  size_t request_number = 0;
-  for (const auto& request : rec_req_positions) {
-    std::vector<Alphabet> tmp(local_text.data_begin() + request.position,
-      local_text.data_begin() + request.position + request.size);
-    std::copy_n(local_text.data_begin() + request.position, request.size,
-      std::back_inserter(response));
-    request_size += request.size;
-    ++request_number;
-    if (request_number >= rec_req_counts[target_pe]) {
-      response_sizes[target_pe++] += request_size;
-      request_number = 0;
-      request_size = 0;
+  size_t cur_request = 0;
+  for (size_t target_pe = 0; target_pe < rec_req_counts.size(); ++target_pe) {
+    for (size_t i = 0; i < rec_req_counts[target_pe]; ++i, ++cur_request) {
+      const auto& request = rec_req_positions[cur_request];
+      std::copy_n(local_text.data_begin() + request.position, request.size,
+        std::back_inserter(response));
+      response_sizes[target_pe] += request.size;
     }
   }
   std::vector<pos_size_request>().swap(rec_req_positions);
   std::vector<Alphabet> rec_characters =
-    dpt::mpi::alltoallv(response, response_sizes);
+    dpt::mpi::adaptive_alltoallv(response, response_sizes);
   // Compute the results with the initially computed offsets.
   std::vector<Alphabet> result;
   result.reserve(rec_characters.size());
@@ -239,29 +235,24 @@ std::pair<std::vector<Alphabet>, std::vector<Alphabet>>
   std::vector<size_t> rec_req_counts;
   std::vector<pos_size_request> rec_req_positions;
   std::tie(rec_req_counts, rec_req_positions) =
-    dpt::mpi::alltoallv_counts(pos_size_requests, counts);
+    dpt::mpi::adaptive_alltoallv_counts(pos_size_requests, counts);
   // Prepare the responses for the received requests (i.e., allocate memory and
   // compute the displacements).
   std::vector<Alphabet> response;
   std::vector<size_t> response_sizes(local_text.text_environment().size(), 0);
-  size_t request_size = 0;
-  size_t target_pe = 0;
-  size_t request_number = 0;
-  for (const auto& request : rec_req_positions) {
-    std::copy_n(local_text.data_begin() + request.position, request.size,
-      std::back_inserter(response));
-    request_size += request.size;
-    ++request_number;
-    if (request_number >= rec_req_counts[target_pe]) {
-      response_sizes[target_pe++] += request_size;
-      request_number = 0;
-      request_size = 0;
+  size_t cur_request = 0;
+  for (size_t target_pe = 0; target_pe < rec_req_counts.size(); ++target_pe) {
+    for (size_t i = 0; i < rec_req_counts[target_pe]; ++i, ++cur_request) {
+      const auto& request = rec_req_positions[cur_request];
+      std::copy_n(local_text.data_begin() + request.position, request.size,
+        std::back_inserter(response));
+      response_sizes[target_pe] += request.size;
     }
   }
 
   std::vector<pos_size_request>().swap(rec_req_positions);
   std::vector<Alphabet> rec_characters =
-    dpt::mpi::alltoallv(response, response_sizes);
+    dpt::mpi::adaptive_alltoallv(response, response_sizes);
   // Compute the results with the initially computed offsets.
   std::vector<Alphabet> result;
   std::vector<Alphabet> heads(text_positions.size(), 0);
@@ -289,9 +280,9 @@ dpt::query::query_list<Alphabet, GlobalIndex, LocalIndex>
     std::vector<Alphabet>& queries, std::vector<LocalIndex>& query_lengths,
     std::vector<size_t>& hist_lengths, std::vector<size_t>& hist) {
 
-    std::vector<Alphabet> received_queries = dpt::mpi::alltoallv(
+    std::vector<Alphabet> received_queries = dpt::mpi::adaptive_alltoallv(
       queries, hist_lengths);
-    std::vector<LocalIndex> recieved_lengths = dpt::mpi::alltoallv(
+    std::vector<LocalIndex> recieved_lengths = dpt::mpi::adaptive_alltoallv(
       query_lengths, hist);
 
     return dpt::query::query_list<Alphabet, GlobalIndex, LocalIndex>(
@@ -30,6 +30,9 @@ class local_communication {
   using q_list = dpt::query::query_list<Alphabet, GlobalIndex, LocalIndex>;
 
 public:
+  /// The text is accessed through the local partition (see \e manager).
+  static constexpr bool remote_memory_access = false;
+
   /// \param text_positions A vector of text positions.
   /// \param local_text The local (partition) of the data to distribute.
   /// \returns Globally distributed characters based on their (global) position.
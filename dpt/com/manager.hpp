@@ -10,8 +10,11 @@
 
 #pragma once
 
+#include <cassert>
+#include <memory>
 #include <mpi.h>
 
+#include "mpi/requestable_array.hpp"
 #include "mpi/type_mapper.hpp"
 #include "mpi/environment.hpp"
 #include "util/partition.hpp"
@@ -25,7 +28,9 @@ namespace com {
 /// constructing the distributed patricia trie (and when answering queries),
 /// some sumbstrings from different processing elements may be required. We
 /// use the \e manager to bundle all this communication in one class that offers
-/// different types of MPI communication (collective and one-sided).
+/// different types of MPI communication (collective and one-sided). For
+/// one-sided communication, the local text is exposed in an MPI window that is
+/// created once (see \e create_text_window) and reused for all requests.
 ///
 /// \tparam Alphabet Type of the data that is distributed.
 /// \tparam GlobalIndex Type of an index position on the global data.
@@ -34,6 +39,7 @@ template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
 class manager {
 
   using partition = dpt::util::partition<Alphabet, GlobalIndex, LocalIndex>;
+  using text_window = dpt::mpi::requestable_array<Alphabet, true>;
 
 public:
   manager() { }
@@ -48,7 +54,7 @@ public:
   std::vector<Alphabet> request_characters(
     std::vector<GlobalIndex>& text_positions) {
     return Communication<Alphabet, GlobalIndex, LocalIndex>
-      ::request_characters(text_positions, local_text_);
+      ::request_characters(text_positions, text<Communication>());
   }
 
   /// \tparam Communication Type of (MPI) communication used. 
@@ -60,7 +66,8 @@ public:
     std::vector<GlobalIndex>& text_positions,
     const std::vector<LocalIndex>& substring_lengths) {
     return Communication<Alphabet, GlobalIndex, LocalIndex>
-      ::request_substrings(text_positions, substring_lengths, local_text_);
+      ::request_substrings(text_positions, substring_lengths,
+        text<Communication>());
   }
 
   /// \tparam Communication Type of (MPI) communication used. 
@@ -75,7 +82,7 @@ public:
       const std::vector<LocalIndex>& substring_lengths) {
         return Communication<Alphabet, GlobalIndex, LocalIndex>
           ::request_substrings_head(
-            text_positions, substring_lengths, local_text_);
+            text_positions, substring_lengths, text<Communication>());
   }
 
   /// \tparam Communication Type of (MPI) communication used. 
@@ -118,8 +125,59 @@ public:
     return std::make_pair(sa, lcp);
   }
 
+  /// \returns The local (partition) of the text managed by this manager.
+  const partition& local_text() const {
+    return local_text_;
+  }
+
+  void save(dpt::util::index_writer& writer) const {
+    local_text_.save(writer);
+  }
+
+  /// \brief Loads the local text. The window of the previous text has to be
+  ///        freed before (see \e free_text_window).
+  bool load(dpt::util::index_reader& reader) {
+    assert(!text_window_);
+    return local_text_.load(reader);
+  }
+
+  /// \brief Exposes the local text (including its padding) in an MPI window
+  ///        that is used by all one-sided requests. This is a collective
+  ///        operation, which has to be called on all PEs before the first
+  ///        one-sided request, as one-sided requests are not collective.
+  void create_text_window() {
+    if (!text_window_) {
+      // The window is only read. A loaded text is mapped privately, i.e., it
+      // is exposed without copying it.
+      const auto* local_data = local_text_.const_local_data();
+      text_window_ = std::make_unique<text_window>(local_data->size(),
+        const_cast<Alphabet*>(local_data->data()), local_text_.global_size(),
+        local_text_.text_environment());
+    }
+  }
+
+  /// \brief Frees the window exposing the local text (collective operation).
+  void free_text_window() {
+    text_window_.reset();
+  }
+
+private:
+  /// \returns The text as required by the communication, i.e., the window
+  ///          for one-sided and the partition for all other communication.
+  template <template <typename, typename, typename> class Communication>
+  auto& text() {
+    if constexpr (Communication<Alphabet, GlobalIndex, LocalIndex>
+      ::remote_memory_access) {
+      assert(text_window_);
+      return *text_window_;
+    } else {
+      return local_text_;
+    }
+  }
+
 private:
   partition local_text_;
+  std::unique_ptr<text_window> text_window_;
 
 }; // class manager
 
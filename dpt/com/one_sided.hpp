@@ -10,11 +10,16 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <memory>
+#include <utility>
+#include <vector>
 
+#include "mpi/environment.hpp"
 #include "mpi/requestable_array.hpp"
+#include "mpi/type_mapper.hpp"
 #include "query/query_list.hpp"
-#include "util/partition.hpp"
 
 namespace dpt {
 namespace com {
@@ -28,91 +33,83 @@ namespace com {
 template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
 class one_sided_communication {
 
-  using partition = dpt::util::partition<Alphabet, GlobalIndex, LocalIndex>;
+  // Requests are completed in passive-target mode, i.e., PEs do not have to
+  // request substrings at the same time.
+  using text_window = dpt::mpi::requestable_array<Alphabet, true>;
   using q_list = dpt::query::query_list<Alphabet, GlobalIndex, LocalIndex>;
 
 private:
   static constexpr size_t MAX_REQUESTS = 2147483647;
 
 public:
+  /// The text is accessed through the window of the \e manager, which is
+  /// created once for the lifetime of the index.
+  static constexpr bool remote_memory_access = true;
 
   /// \param text_positions A vector of text positions.
-  /// \param local_text The local (partition) of the data to distribute.
+  /// \param window Window exposing the local text of all PEs.
   /// \returns Globally distributed characters based on their (global) position.
   static std::vector<Alphabet> request_characters(
-    std::vector<GlobalIndex>& text_positions,
-    partition& local_text);
+    const std::vector<GlobalIndex>& text_positions, text_window& window);
 
   /// \param text_positions A vector of text positions.
   /// \param substring_lengths A vector of length of the requested substrings.
-  /// \param local_text The local (partition) of the data to distribute.
+  /// \param window Window exposing the local text of all PEs.
   /// \returns Globally distributed substrings based on their (global) position.
   static std::vector<Alphabet> request_substrings(
-    std::vector<GlobalIndex>& text_positions,
-    const std::vector<LocalIndex>& substring_lengths,
-    partition& local_text_);
+    const std::vector<GlobalIndex>& text_positions,
+    const std::vector<LocalIndex>& substring_lengths, text_window& window);
   
   /// \param text_positions A vector of text positions.
   /// \param substring_lengths A vector of length of the requested substrings.
-  /// \param local_text The local (partition) of the data to distribute.
+  /// \param window Window exposing the local text of all PEs.
   /// \returns Globally distributed substrings based on their (global) position
   ///          but returns the first character (head) of each substring in a
   ///          separate vector.
   static std::pair<std::vector<Alphabet>, std::vector<Alphabet>>
-    request_substrings_head(std::vector<GlobalIndex>& text_positions,
-      const std::vector<LocalIndex>& substring_lengths,
-      partition& local_text);
-
+    request_substrings_head(const std::vector<GlobalIndex>& text_positions,
+      const std::vector<LocalIndex>& substring_lengths, text_window& window);
+
+  /// \brief Each PE reserves space in the receive buffers of its target PEs
+  ///        (using \e MPI_Fetch_and_op on their byte counters) and puts its
+  ///        queries there. Only non-empty targets are accessed. The receive
+  ///        buffer of each PE is a single window, whose size depends on the
+  ///        queries, i.e., it is created for each batch of queries.
+  ///
   /// \param queries A vector of text (all queries concatenated w/o separator).
   /// \param query_lengths A vector of length of the queries.
-  /// \param local_text The local (partition) of the data to distribute.
-  /// \returns All queries that have been send to this processing element.
+  /// \param hist_lengths Number of characters sent to each PE.
+  /// \param hist Number of queries sent to each PE.
+  /// \returns All queries that have been send to this processing element
+  ///          (ordered by the rank of the sending PE).
   static q_list distribute_queries(
-    const std::vector<Alphabet>& queries,
-    const std::vector<LocalIndex>& query_lengths,
-    const std::vector<int32_t> hist_lengths, const std::vector<int32_t> hist);
+    std::vector<Alphabet>& queries, std::vector<LocalIndex>& query_lengths,
+    std::vector<size_t>& hist_lengths, std::vector<size_t>& hist);
 
 }; // class one_sided_communication
 
 template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
 std::vector<Alphabet> one_sided_communication<Alphabet, GlobalIndex, LocalIndex>
-  ::request_characters(std::vector<GlobalIndex>& text_positions,
-     partition& local_text) {
-  dpt::mpi::requestable_array requestable(local_text.global_size(),
-                                          local_text.local_data()->data(),
-                                          local_text.local_size());
-  auto result = requestable.request(text_positions);
-  return result;
+  ::request_characters(const std::vector<GlobalIndex>& text_positions,
+    text_window& window) {
+  return window.request(text_positions);
 } // request_characters
 
 template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
 std::vector<Alphabet> one_sided_communication<Alphabet, GlobalIndex, LocalIndex>
   ::request_substrings(
-    std::vector<GlobalIndex>& text_positions,
-    const std::vector<LocalIndex>& substring_lengths,
-    partition& local_text) {
-
-  dpt::mpi::requestable_array requestable(local_text.global_size(),
-                                          local_text.local_data()->data(),
-                                          local_text.local_size());
-
-  std::vector<Alphabet> result = requestable.request(text_positions,
-                                                     substring_lengths);
-  return result;
+    const std::vector<GlobalIndex>& text_positions,
+    const std::vector<LocalIndex>& substring_lengths, text_window& window) {
+  return window.request(text_positions, substring_lengths);
 } // request_substrings
 
 template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
 std::pair<std::vector<Alphabet>, std::vector<Alphabet>>
   one_sided_communication<Alphabet, GlobalIndex, LocalIndex>
-  ::request_substrings_head(std::vector<GlobalIndex>& text_positions,
-    const std::vector<LocalIndex>& substring_lengths,
-    partition& local_text) {
+  ::request_substrings_head(const std::vector<GlobalIndex>& text_positions,
+    const std::vector<LocalIndex>& substring_lengths, text_window& window) {
 
-  dpt::mpi::requestable_array requestable(local_text.global_size(),
-                                          local_text.local_data()->data(),
-                                          local_text.local_size());
-
-  auto heads = requestable.request(text_positions);
+  auto heads = window.request(text_positions);
 
   std::vector<GlobalIndex> tail_pos(text_positions.size());
   std::vector<LocalIndex> tail_length(substring_lengths.size());
@@ -121,7 +118,7 @@ std::pair<std::vector<Alphabet>, std::vector<Alphabet>>
     tail_length[i] = substring_lengths[i] - 1;
   }
 
-  auto tails = requestable.request(tail_pos, tail_length);
+  auto tails = window.request(tail_pos, tail_length);
 
   return std::make_pair(heads, tails);
 
@@ -131,14 +128,113 @@ template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
 dpt::query::query_list<Alphabet, GlobalIndex, LocalIndex>
 one_sided_communication<Alphabet, GlobalIndex, LocalIndex>
   ::distribute_queries(
-    const std::vector<Alphabet>& queries,
-    const std::vector<LocalIndex>& query_lengths,
-    const std::vector<int32_t> hist_lengths, const std::vector<int32_t> hist) {
-
-  std::cout << "Not yet implemented. Please use 'collective "
-            << "communication' to distribute queries" << std::endl;
+    std::vector<Alphabet>& queries, std::vector<LocalIndex>& query_lengths,
+    std::vector<size_t>& hist_lengths, std::vector<size_t>& hist) {
+
+  dpt::mpi::environment env;
+  const auto counter_type = dpt::mpi::type_mapper<uint64_t>::type();
+  dpt::mpi::data_type_mapper<Alphabet> alphabet_dtm;
+  dpt::mpi::data_type_mapper<LocalIndex> index_dtm;
+
+  // The queries of each sending PE are stored in one segment of the receive
+  // buffer: a header (the rank of the sending PE, the number of queries and
+  // the number of characters), the query lengths, and the queries. Each part
+  // starts at a multiple of 8 bytes.
+  constexpr size_t header_size = 3;
+  auto aligned = [](const size_t bytes) {
+    return (bytes + 7) & ~size_t(7);
+  };
+  auto segment_bytes = [&aligned](const size_t nr_queries,
+    const size_t nr_characters) {
+    return header_size * sizeof(uint64_t) +
+      aligned(nr_queries * sizeof(LocalIndex)) +
+      aligned(nr_characters * sizeof(Alphabet));
+  };
+
+  // Each sending PE fetches (and increases) the number of bytes received by
+  // its target PEs to reserve its segments. The origin buffers must not be
+  // reused before the epoch has been closed.
+  uint64_t rec_bytes = 0;
+  std::vector<uint64_t> send_bytes(env.size(), 0);
+  std::vector<uint64_t> reserved(env.size(), 0);
+  MPI_Win counter_win;
+  MPI_Win_create(&rec_bytes, sizeof(uint64_t), sizeof(uint64_t),
+    MPI_INFO_NULL, env.communicator(), &counter_win);
+  MPI_Win_fence(MPI_MODE_NOPRECEDE, counter_win);
+  for (int32_t pe = 0; pe < env.size(); ++pe) {
+    if (hist[pe] > 0) {
+      send_bytes[pe] = segment_bytes(hist[pe], hist_lengths[pe]);
+      MPI_Fetch_and_op(&send_bytes[pe], &reserved[pe], counter_type, pe, 0,
+        MPI_SUM, counter_win);
+    }
+  }
+  MPI_Win_fence(MPI_MODE_NOSUCCEED, counter_win);
+  MPI_Win_free(&counter_win);
+
+  // All segments are put into a single window (addressed in bytes), whose
+  // size is only known now.
+  char* rec_data = nullptr;
+  MPI_Win data_win;
+  MPI_Win_allocate(rec_bytes, 1, MPI_INFO_NULL, env.communicator(),
+    &rec_data, &data_win);
+  MPI_Win_fence(MPI_MODE_NOPRECEDE, data_win);
+  std::vector<std::array<uint64_t, header_size>> headers(env.size());
+  size_t query_offset = 0;
+  size_t length_offset = 0;
+  for (int32_t pe = 0; pe < env.size(); ++pe) {
+    if (hist[pe] > 0) {
+      headers[pe] = { uint64_t(env.rank()), hist[pe], hist_lengths[pe] };
+      const size_t length_disp = reserved[pe] + header_size * sizeof(uint64_t);
+      const size_t query_disp =
+        length_disp + aligned(hist[pe] * sizeof(LocalIndex));
+      MPI_Put(headers[pe].data(), header_size, counter_type, pe, reserved[pe],
+        header_size, counter_type, data_win);
+      MPI_Put(query_lengths.data() + length_offset, hist[pe],
+        index_dtm.get_mpi_type(), pe, length_disp, hist[pe],
+        index_dtm.get_mpi_type(), data_win);
+      MPI_Put(queries.data() + query_offset, hist_lengths[pe],
+        alphabet_dtm.get_mpi_type(), pe, query_disp, hist_lengths[pe],
+        alphabet_dtm.get_mpi_type(), data_win);
+    }
+    query_offset += hist_lengths[pe];
+    length_offset += hist[pe];
+  }
+  MPI_Win_fence(MPI_MODE_NOSUCCEED, data_win);
+
+  // The segments have been reserved in arbitrary order. The queries are
+  // reordered by the rank of the sending PE (as with alltoallv).
+  std::vector<std::pair<uint64_t, size_t>> segments;
+  size_t nr_queries = 0;
+  size_t nr_characters = 0;
+  for (size_t offset = 0; offset < rec_bytes; ) {
+    const uint64_t* header =
+      reinterpret_cast<const uint64_t*>(rec_data + offset);
+    segments.emplace_back(header[0], offset);
+    nr_queries += header[1];
+    nr_characters += header[2];
+    offset += segment_bytes(header[1], header[2]);
+  }
+  std::sort(segments.begin(), segments.end());
+  std::vector<Alphabet> ordered_queries;
+  std::vector<LocalIndex> ordered_lengths;
+  ordered_queries.reserve(nr_characters);
+  ordered_lengths.reserve(nr_queries);
+  for (const auto& segment : segments) {
+    const char* data = rec_data + segment.second;
+    const uint64_t* header = reinterpret_cast<const uint64_t*>(data);
+    const LocalIndex* lengths = reinterpret_cast<const LocalIndex*>(
+      data + header_size * sizeof(uint64_t));
+    const Alphabet* chars = reinterpret_cast<const Alphabet*>(
+      data + header_size * sizeof(uint64_t) +
+      aligned(header[1] * sizeof(LocalIndex)));
+    ordered_lengths.insert(ordered_lengths.end(), lengths,
+      lengths + header[1]);
+    ordered_queries.insert(ordered_queries.end(), chars, chars + header[2]);
+  }
+  MPI_Win_free(&data_win);
 
-  return dpt::query::query_list<Alphabet, GlobalIndex, LocalIndex>();
+  return dpt::query::query_list<Alphabet, GlobalIndex, LocalIndex>(
+    std::move(ordered_queries), std::move(ordered_lengths));
 
 } // distribute_queries
 
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <mpi.h>
 #include <vector>
 
@@ -20,7 +21,17 @@
 namespace dpt {
 namespace mpi {
 
-template <typename DataType>
+/// \brief Exposes local data in an MPI window such that (global) positions
+///        can be requested from all processing elements using one-sided
+///        communication. The window is created once and freed on destruction.
+///
+/// \tparam DataType Type of the exposed data.
+/// \tparam PassiveTarget If \e true, the window is locked (shared) for all
+///         processing elements during its lifetime and requests are completed
+///         using \e MPI_Win_flush_local_all. Then, requests are no collective
+///         operations and each processing element only waits for its own
+///         requests. Otherwise, requests are synchronized using fences.
+template <typename DataType, bool PassiveTarget = false>
 class requestable_array {
 
 public:
@@ -28,26 +39,28 @@ public:
                     environment env = environment())
     : local_size_(data.size()), slice_size_(total_size / env.size()),
       data_(data.data()), env_(env) {
-    
-    MPI_Win_create(data_,
-                   local_size_,
-                   sizeof(DataType),
-                   MPI_INFO_NULL,
-                   env_.communicator(),
-                   &win_);
+    create_window();
   }
 
   requestable_array(size_t local_size, DataType* data, size_t total_size,
                     environment env = environment())
     : local_size_(local_size), slice_size_(total_size / env.size()),
-      data_(data), env_(env){
+      data_(data), env_(env) {
+    create_window();
+  }
 
-    MPI_Win_create(data_,
-                   local_size_,
-                   sizeof(DataType),
-                   MPI_INFO_NULL,
-                   env_.communicator(),
-                   &win_);
+  // The window is exposed collectively, hence, the array cannot be copied.
+  requestable_array(const requestable_array&) = delete;
+  requestable_array& operator = (const requestable_array&) = delete;
+
+  /// \brief Frees the window (collective operation).
+  ~requestable_array() {
+    if (!environment::finalized()) {
+      if constexpr (PassiveTarget) {
+        MPI_Win_unlock_all(win_);
+      }
+      MPI_Win_free(&win_);
+    }
   }
 
   inline DataType& operator [](size_t index) {
@@ -66,81 +79,184 @@ public:
     return data_[local_size_ - 1];
   }
 
+  /// \param request_positions Global positions of the requested elements.
+  /// \returns The requested elements (in the order of the requests).
   template <typename IndexType>
-  std::vector<DataType> request(std::vector<IndexType>& request_positions) {
-    std::vector<DataType> result(request_positions.size());
-    
+  std::vector<DataType> request(
+    const std::vector<IndexType>& request_positions) {
+    return request_substrings(request_positions, [](const size_t) {
+      return size_t(1); });
+  }
+
+  /// \param request_positions Global positions of the requested substrings.
+  /// \param request_lengths Lengths of the requested substrings.
+  /// \returns The requested substrings (concatenated in the order of the
+  ///          requests).
+  template <typename IndexType, typename LocalIndex>
+  std::vector<DataType> request(
+    const std::vector<IndexType>& request_positions,
+    const std::vector<LocalIndex>& request_lengths) {
+    return request_substrings(request_positions,
+      [&request_lengths](const size_t req) {
+        return size_t(request_lengths[req]); });
+  }
+
+private:
+  /// \brief Requests substrings. The requests of each round are grouped by
+  ///        their target PE and each group is fetched with a single
+  ///        \e MPI_Get, using an indexed datatype (sorted by the positions on
+  ///        the target PE). Afterwards, the substrings are put back into the
+  ///        order of the requests.
+  template <typename IndexType, typename LengthFunction>
+  std::vector<DataType> request_substrings(
+    const std::vector<IndexType>& request_positions,
+    LengthFunction request_length) {
+    // Position of each requested substring in the result.
+    std::vector<size_t> result_positions(request_positions.size() + 1, 0);
+    for (size_t req = 0; req < request_positions.size(); ++req) {
+      result_positions[req + 1] = result_positions[req] + request_length(req);
+    }
+    std::vector<DataType> result(result_positions.back());
+
+    std::vector<size_t> pe_begin(env_.size() + 1);
+    std::vector<int32_t> target_pes;
+    std::vector<size_t> order;
+    std::vector<DataType> buffer;
+    std::vector<int32_t> block_lengths;
+    std::vector<MPI_Aint> displacements;
+    std::vector<MPI_Datatype> target_types;
+
     bool completed = false;
-    size_t cur_pos = 0;
+    size_t cur_begin = 0;
     size_t iteration = 1;
     while (!completed) {
       size_t const cur_end = std::min(request_positions.size(),
                                       iteration * req_round_size);
-      MPI_Win_fence(MPI_MODE_NOSTORE | MPI_MODE_NOPUT | MPI_MODE_NOPRECEDE, win_);
+      const size_t round_size = cur_end - cur_begin;
 
-      for (; cur_pos < cur_end; ++cur_pos) {
-        int32_t rank = std::min<int32_t>(request_positions[cur_pos] / slice_size_,
-                                         env_.size() - 1);
-        size_t pos = request_positions[cur_pos] - (rank * slice_size_);
+      // Group the requests of this round by their target PE.
+      target_pes.resize(round_size);
+      std::fill(pe_begin.begin(), pe_begin.end(), 0);
+      for (size_t req = cur_begin; req < cur_end; ++req) {
+        target_pes[req - cur_begin] = target_pe(request_positions[req]);
+        ++pe_begin[target_pes[req - cur_begin] + 1];
+      }
+      for (int32_t pe = 0; pe < env_.size(); ++pe) {
+        pe_begin[pe + 1] += pe_begin[pe];
+      }
+      order.resize(round_size);
+      {
+        std::vector<size_t> pe_fill(pe_begin.begin(), pe_begin.end() - 1);
+        for (size_t req = cur_begin; req < cur_end; ++req) {
+          order[pe_fill[target_pes[req - cur_begin]]++] = req;
+        }
+      }
 
-        MPI_Get(result.data() + cur_pos,
-                1,
+      begin_round();
+      size_t buffer_size = 0;
+      for (size_t req = cur_begin; req < cur_end; ++req) {
+        buffer_size += request_length(req);
+      }
+      buffer.resize(buffer_size);
+      size_t buffer_pos = 0;
+      for (int32_t pe = 0; pe < env_.size(); ++pe) {
+        if (pe_begin[pe] == pe_begin[pe + 1]) {
+          continue;
+        }
+        std::sort(order.begin() + pe_begin[pe],
+          order.begin() + pe_begin[pe + 1],
+          [&request_positions](const size_t lhs, const size_t rhs) {
+            return request_positions[lhs] < request_positions[rhs]; });
+        const size_t pe_offset = pe * slice_size_;
+        block_lengths.clear();
+        displacements.clear();
+        size_t pe_size = 0;
+        for (size_t i = pe_begin[pe]; i < pe_begin[pe + 1]; ++i) {
+          block_lengths.emplace_back(request_length(order[i]));
+          displacements.emplace_back(MPI_Aint(
+            (request_positions[order[i]] - pe_offset) * sizeof(DataType)));
+          pe_size += block_lengths.back();
+        }
+        MPI_Datatype target_type;
+        MPI_Type_create_hindexed(block_lengths.size(), block_lengths.data(),
+          displacements.data(), dtm_.get_mpi_type(), &target_type);
+        MPI_Type_commit(&target_type);
+        target_types.emplace_back(target_type);
+
+        MPI_Get(buffer.data() + buffer_pos,
+                pe_size,
                 dtm_.get_mpi_type(),
-                rank,
-                pos,
+                pe,
+                0,
                 1,
-                dtm_.get_mpi_type(),
+                target_type,
                 win_);
+        buffer_pos += pe_size;
       }
-      MPI_Win_fence(MPI_MODE_NOSTORE | MPI_MODE_NOSUCCEED, win_);
+      completed = end_round(request_positions.size() == cur_end);
+      for (auto& target_type : target_types) {
+        MPI_Type_free(&target_type);
+      }
+      target_types.clear();
 
-      bool tmp_completed = (request_positions.size() == cur_pos);
-      completed = dpt::mpi::allreduce_and(tmp_completed);
+      // The buffer contains the substrings grouped by PE, i.e., in the order
+      // given by order.
+      buffer_pos = 0;
+      for (const auto req : order) {
+        std::copy_n(buffer.begin() + buffer_pos, request_length(req),
+          result.begin() + result_positions[req]);
+        buffer_pos += request_length(req);
+      }
+      cur_begin = cur_end;
       ++iteration;
     }
     return result;
   }
 
-  template <typename IndexType, typename LocalIndex>
-  std::vector<DataType> request(std::vector<IndexType>& request_positions,
-                                std::vector<LocalIndex>& request_lengths) {
-    size_t total_length = 0;
-    for (const auto length : request_lengths) {
-      total_length += length;
+  /// \returns The PE containing the element at global position \e position
+  ///          (the last PE if there are fewer elements than PEs).
+  template <typename IndexType>
+  inline int32_t target_pe(const IndexType position) const {
+    if (slice_size_ == 0) {
+      return env_.size() - 1;
     }
-    std::vector<DataType> result(total_length);
-    
-    bool completed = false;
-    size_t cur_req = 0;
-    size_t cur_pos = 0;
-    size_t iteration = 1;
-    while (!completed) {
-      size_t const cur_end = std::min(request_positions.size(),
-                                      iteration * req_round_size);
-      MPI_Win_fence(MPI_MODE_NOSTORE | MPI_MODE_NOPUT | MPI_MODE_NOPRECEDE, win_);
+    return std::min<int32_t>(position / slice_size_, env_.size() - 1);
+  }
 
-      for (; cur_req < cur_end; ++cur_req) {
-        int32_t rank = std::min<int32_t>(request_positions[cur_req] / slice_size_,
-                                         env_.size() - 1);
-        size_t pos = request_positions[cur_req] - (rank * slice_size_);
+  void create_window() {
+    MPI_Win_create(data_,
+                   local_size_ * sizeof(DataType),
+                   sizeof(DataType),
+                   MPI_INFO_NULL,
+                   env_.communicator(),
+                   &win_);
+    if constexpr (PassiveTarget) {
+      // The exposed data is never changed, hence, no exclusive locks are used.
+      MPI_Win_lock_all(MPI_MODE_NOCHECK, win_);
+    }
+  }
 
-        MPI_Get(result.data() + cur_pos,
-                request_lengths[cur_req],
-                dtm_.get_mpi_type(),
-                rank,
-                pos,
-                request_lengths[cur_req],
-                dtm_.get_mpi_type(),
-                win_);
-      }
-      MPI_Win_fence(MPI_MODE_NOSTORE | MPI_MODE_NOSUCCEED, win_);
+  /// \brief Opens an access epoch (only required for fences).
+  inline void begin_round() {
+    if constexpr (!PassiveTarget) {
+      MPI_Win_fence(MPI_MODE_NOSTORE | MPI_MODE_NOPUT | MPI_MODE_NOPRECEDE,
+        win_);
+    }
+  }
 
-      bool tmp_completed = (request_positions.size() == cur_req);
-      completed = dpt::mpi::allreduce_and(tmp_completed);
-      cur_pos += request_lengths[cur_req];
-      ++iteration;
+  /// \brief Completes all requests of the current round.
+  /// \param completed Whether this processing element issued all requests.
+  /// \returns \e true if all requests have been issued, i.e., by this
+  ///          processing element (passive target) or by all processing
+  ///          elements (fences).
+  inline bool end_round(bool completed) {
+    if constexpr (PassiveTarget) {
+      MPI_Win_flush_local_all(win_);
+      return completed;
+    } else {
+      MPI_Win_fence(MPI_MODE_NOSTORE | MPI_MODE_NOSUCCEED, win_);
+      return dpt::mpi::allreduce_and(completed);
     }
-    return result;
   }
 
 private:
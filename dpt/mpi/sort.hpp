@@ -0,0 +1,94 @@
+/*******************************************************************************
+ * dpt/mpi/sort.hpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <mpi.h>
+#include <vector>
+
+#include "mpi/all_to_all.hpp"
+#include "mpi/environment.hpp"
+#include "mpi/type_mapper.hpp"
+
+namespace dpt {
+namespace mpi {
+
+/// \brief Distributed sample sort. After the call, the local data of each
+///        processing element is sorted and all elements on processing element
+///        \e i are not greater than the elements on processing element
+///        \e i + 1. The number of elements per processing element may change.
+///
+/// \tparam DataType Type of the elements that are sorted (must be trivial).
+/// \tparam Compare Type of the comparison function.
+/// \param local_data The local elements, replaced by the sorted local slice.
+/// \param comp Strict weak ordering used for sorting.
+template <typename DataType, typename Compare = std::less<DataType>>
+inline void sample_sort(std::vector<DataType>& local_data,
+  Compare comp = Compare(), environment env = environment()) {
+
+  std::sort(local_data.begin(), local_data.end(), comp);
+  if (env.size() == 1) {
+    return;
+  }
+
+  // Each processing element contributes (up to) 16 * p regular samples.
+  const size_t oversampling = 16 * env.size();
+  const size_t nr_samples = std::min(oversampling, local_data.size());
+  std::vector<DataType> samples;
+  samples.reserve(nr_samples);
+  for (size_t i = 0; i < nr_samples; ++i) {
+    samples.emplace_back(
+      local_data[((i + 1) * local_data.size()) / (nr_samples + 1)]);
+  }
+
+  data_type_mapper<DataType> dtm;
+  int32_t local_nr_samples = static_cast<int32_t>(samples.size());
+  std::vector<int32_t> sample_counts(env.size(), 0);
+  MPI_Allgather(&local_nr_samples, 1, MPI_INT, sample_counts.data(), 1,
+    MPI_INT, env.communicator());
+  std::vector<int32_t> sample_displacements(env.size(), 0);
+  for (int32_t i = 1; i < env.size(); ++i) {
+    sample_displacements[i] = sample_displacements[i - 1] +
+      sample_counts[i - 1];
+  }
+  std::vector<DataType> all_samples(
+    sample_displacements.back() + sample_counts.back());
+  MPI_Allgatherv(samples.data(), local_nr_samples, dtm.get_mpi_type(),
+    all_samples.data(), sample_counts.data(), sample_displacements.data(),
+    dtm.get_mpi_type(), env.communicator());
+  std::sort(all_samples.begin(), all_samples.end(), comp);
+
+  // Select p - 1 splitters and compute the buckets of the (sorted) local data.
+  std::vector<size_t> send_counts(env.size(), 0);
+  if (all_samples.size() > 0) {
+    auto bucket_begin = local_data.begin();
+    for (int32_t i = 0; i + 1 < env.size(); ++i) {
+      const auto& splitter =
+        all_samples[((i + 1) * all_samples.size()) / env.size()];
+      const auto bucket_end = std::upper_bound(bucket_begin, local_data.end(),
+        splitter, comp);
+      send_counts[i] = std::distance(bucket_begin, bucket_end);
+      bucket_begin = bucket_end;
+    }
+    send_counts.back() = std::distance(bucket_begin, local_data.end());
+  } else {
+    send_counts[env.rank()] = local_data.size();
+  }
+
+  local_data = alltoallv(local_data, send_counts, env);
+  std::sort(local_data.begin(), local_data.end(), comp);
+}
+
+} // namespace mpi
+} // namespace dpt
+
+/******************************************************************************/
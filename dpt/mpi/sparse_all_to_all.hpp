@@ -0,0 +1,175 @@
+/*******************************************************************************
+ * dpt/mpi/sparse_all_to_all.hpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <mpi.h>
+#include <vector>
+
+#include "mpi/all_to_all.hpp"
+#include "mpi/environment.hpp"
+#include "mpi/type_mapper.hpp"
+
+namespace dpt {
+namespace mpi {
+
+/// \returns The tag used by the next sparse all-to-all exchange. Two
+///          consecutive exchanges may overlap, i.e., a PE can start the next
+///          exchange while another PE is still waiting for the barrier of the
+///          previous one. Hence, the tags alternate (for all data types).
+inline int32_t next_sparse_alltoall_tag() {
+  static size_t exchange = 0;
+  return 44228 + static_cast<int32_t>(exchange++ & 1);
+}
+
+/// \brief Sparse all-to-all exchange using the NBX algorithm (non-blocking
+///        consensus): each PE only sends to the PEs with a non-zero send
+///        count (using synchronous sends) and receives (probed) messages until
+///        all its sends have been matched and a non-blocking barrier, which
+///        it enters afterwards, has been completed. In contrast to
+///        \e alltoallv_counts, there is no dense exchange of the send counts.
+///        All messages have to be smaller than \e mpi_max_int.
+///
+/// \param send_data Data sent to all PEs (ordered by the target PE).
+/// \param send_counts Number of elements sent to each PE.
+/// \returns The number of elements received from each PE and the received
+///          data (ordered by the source PE).
+template <typename DataType>
+inline std::pair<std::vector<size_t>, std::vector<DataType>>
+  sparse_alltoallv_counts(std::vector<DataType>& send_data,
+    std::vector<size_t>& send_counts, environment env = environment()) {
+  const int32_t tag = next_sparse_alltoall_tag();
+
+  data_type_mapper<DataType> dtm;
+  std::vector<size_t> receive_counts(env.size(), 0);
+  std::vector<std::vector<DataType>> receive_buffers(env.size());
+
+  std::vector<MPI_Request> send_requests;
+  size_t send_displacement = 0;
+  for (int32_t target = 0; target < env.size(); ++target) {
+    if (target == env.rank()) {
+      receive_buffers[target].assign(
+        send_data.begin() + send_displacement,
+        send_data.begin() + send_displacement + send_counts[target]);
+    } else if (send_counts[target] > 0) {
+      send_requests.emplace_back();
+      MPI_Issend(send_data.data() + send_displacement,
+                 static_cast<int32_t>(send_counts[target]),
+                 dtm.get_mpi_type(),
+                 target,
+                 tag,
+                 env.communicator(),
+                 &send_requests.back());
+    }
+    send_displacement += send_counts[target];
+  }
+
+  MPI_Request barrier_request;
+  bool barrier_active = false;
+  while (true) {
+    int32_t has_message = 0;
+    MPI_Status status;
+    MPI_Iprobe(MPI_ANY_SOURCE, tag, env.communicator(), &has_message, &status);
+    if (has_message) {
+      int32_t count = 0;
+      MPI_Get_count(&status, dtm.get_mpi_type(), &count);
+      receive_buffers[status.MPI_SOURCE].resize(count);
+      MPI_Recv(receive_buffers[status.MPI_SOURCE].data(),
+               count,
+               dtm.get_mpi_type(),
+               status.MPI_SOURCE,
+               tag,
+               env.communicator(),
+               MPI_STATUS_IGNORE);
+    }
+    int32_t completed = 0;
+    if (barrier_active) {
+      MPI_Test(&barrier_request, &completed, MPI_STATUS_IGNORE);
+      if (completed) {
+        break;
+      }
+    } else {
+      MPI_Testall(send_requests.size(), send_requests.data(), &completed,
+        MPI_STATUSES_IGNORE);
+      if (completed) {
+        MPI_Ibarrier(env.communicator(), &barrier_request);
+        barrier_active = true;
+      }
+    }
+  }
+
+  size_t receive_size = 0;
+  for (int32_t source = 0; source < env.size(); ++source) {
+    receive_counts[source] = receive_buffers[source].size();
+    receive_size += receive_counts[source];
+  }
+  std::vector<DataType> receive_data;
+  receive_data.reserve(receive_size);
+  for (auto& buffer : receive_buffers) {
+    receive_data.insert(receive_data.end(), buffer.begin(), buffer.end());
+    std::vector<DataType>().swap(buffer);
+  }
+  return std::make_pair(receive_counts, receive_data);
+}
+
+/// \brief Decides (globally) whether the sparse exchange is used. This is the
+///        case if each PE sends to only a few PEs (at most one eighth of all
+///        PEs) and all messages are smaller than \e mpi_max_int.
+///
+/// \param send_counts Number of elements sent to each PE.
+/// \returns \e true if \e sparse_alltoallv_counts should be used.
+inline bool use_sparse_alltoall(const std::vector<size_t>& send_counts,
+  environment env = environment()) {
+  std::array<uint64_t, 2> local_max = { 0, 0 };
+  for (const auto count : send_counts) {
+    local_max[0] += (count > 0) ? 1 : 0;
+    local_max[1] = std::max<uint64_t>(local_max[1], count);
+  }
+  std::array<uint64_t, 2> global_max;
+  MPI_Allreduce(local_max.data(),
+                global_max.data(),
+                local_max.size(),
+                type_mapper<uint64_t>::type(),
+                MPI_MAX,
+                env.communicator());
+  return (global_max[0] * 8 <= static_cast<uint64_t>(env.size())) &&
+    (global_max[1] < env.mpi_max_int());
+}
+
+/// \brief Uses either \e sparse_alltoallv_counts or \e alltoallv_counts
+///        (see \e use_sparse_alltoall).
+template <typename DataType>
+inline std::pair<std::vector<size_t>, std::vector<DataType>>
+  adaptive_alltoallv_counts(std::vector<DataType>& send_data,
+    std::vector<size_t>& send_counts, environment env = environment()) {
+  if (use_sparse_alltoall(send_counts, env)) {
+    return sparse_alltoallv_counts(send_data, send_counts, env);
+  }
+  return alltoallv_counts(send_data, send_counts, env);
+}
+
+/// \brief Uses either \e sparse_alltoallv_counts or \e alltoallv
+///        (see \e use_sparse_alltoall).
+template <typename DataType>
+inline std::vector<DataType> adaptive_alltoallv(
+  std::vector<DataType>& send_data, std::vector<size_t>& send_counts,
+  environment env = environment()) {
+  if (use_sparse_alltoall(send_counts, env)) {
+    return sparse_alltoallv_counts(send_data, send_counts, env).second;
+  }
+  return alltoallv(send_data, send_counts, env);
+}
+
+} // namespace mpi
+} // namespace dpt
+
+/******************************************************************************/
@@ -11,6 +11,11 @@
 #pragma once
 
 #include <algorithm>
+#include <iterator>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "query/query_iterator.hpp"
 #include "query/query_view.hpp"
@@ -88,6 +93,35 @@ public:
       *this, size());
   }
 
+  /// \brief Removes duplicate queries. Queries are hashed by their bytes.
+  ///
+  /// \return A query list containing each distinct query once (in the order
+  ///         of their first occurrence) and, for each query of this list, the
+  ///         index of the same query in the returned list.
+  std::pair<query_list, std::vector<size_t>> distinct() const {
+    std::unordered_map<std::string_view, size_t> distinct_indices;
+    distinct_indices.reserve(size());
+    query_list distinct_queries;
+    distinct_queries.start_positions_.emplace_back(0);
+    std::vector<size_t> representatives;
+    representatives.reserve(size());
+    for (size_t i = 0; i < size(); ++i) {
+      const auto query = (*this)[i];
+      const auto inserted = distinct_indices.emplace(std::string_view(
+        reinterpret_cast<const char*>(query.query),
+        query.length * sizeof(Alphabet)), distinct_queries.size());
+      if (inserted.second) {
+        std::copy_n(query.query, query.length,
+          std::back_inserter(distinct_queries.queries_));
+        distinct_queries.start_positions_.emplace_back(
+          distinct_queries.queries_.size());
+      }
+      representatives.emplace_back(inserted.first->second);
+    }
+    return std::make_pair(std::move(distinct_queries),
+      std::move(representatives));
+  }
+
 private:
   std::vector<Alphabet> queries_;
   std::vector<LocalIndex> start_positions_;
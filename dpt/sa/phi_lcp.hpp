@@ -0,0 +1,211 @@
+/*******************************************************************************
+ * dpt/sa/phi_lcp.hpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <mpi.h>
+#include <vector>
+
+#include "com/manager.hpp"
+#include "mpi/all_to_all.hpp"
+#include "mpi/allreduce.hpp"
+#include "mpi/environment.hpp"
+#include "mpi/type_mapper.hpp"
+#include "util/partition.hpp"
+
+namespace dpt {
+namespace sa {
+
+/// \brief Tuple consisting of a suffix and its predecessor in the suffix
+///        array, i.e., \e phi[suffix] = \e predecessor.
+///
+/// \tparam GlobalIndex Type of an index position on the global data.
+template <typename GlobalIndex>
+struct suffix_phi {
+  GlobalIndex suffix;
+  GlobalIndex predecessor;
+  bool has_predecessor;
+} __attribute__ ((packed)); // struct suffix_phi
+
+/// \brief Distributed LCP-array construction using the permuted LCP-array.
+///
+/// First, we send each suffix together with its predecessor in the suffix
+/// array (\e phi) to the processing element containing the suffix in the text.
+/// There, we compute the permuted LCP-array (in text order) by comparing the
+/// local suffixes with the remote ones using \e request_substrings. We request
+/// the characters in rounds of doubling length and use that PLCP[i + 1] >=
+/// PLCP[i] - 1 to skip characters that are known to be equal. Finally, the
+/// LCP-values are send back and permuted into suffix array order.
+///
+/// LCP-values are only computed up to \e max_lcp, i.e., all larger values are
+/// reported as \e max_lcp. The local text must be padded with at least
+/// \e max_lcp characters (of the following processing element).
+///
+/// \tparam Communication Type of (MPI) communication used.
+/// \tparam Alphabet Type of the characters of the text.
+/// \tparam GlobalIndex Type of an index position on the global data.
+/// \tparam LocalIndex Type of an index position on the local data.
+/// \param local_sa The local slice of the suffix array.
+/// \param manager Manager containing the local text.
+/// \param max_lcp Maximum LCP-value that is computed.
+/// \returns The local slice of the LCP-array (distributed like \e local_sa).
+template <template <typename, typename, typename> class Communication,
+          typename Alphabet, typename GlobalIndex, typename LocalIndex>
+dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex> phi_lcp(
+  const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_sa,
+  dpt::com::manager<Alphabet, GlobalIndex, LocalIndex>& manager,
+  const GlobalIndex max_lcp) {
+
+  using phi_tuple = suffix_phi<GlobalIndex>;
+
+  const auto& local_text = manager.local_text();
+  dpt::mpi::environment env = local_sa.text_environment();
+  const uint64_t global_size = local_text.global_size();
+  const uint64_t text_size = local_text.local_size();
+  // Distributed like dpt::mpi::distribute_file: all but the last PE contain
+  // slice_size elements (which is 0 if there are fewer elements than PEs) and
+  // the last PE contains the remaining ones.
+  const uint64_t slice_size = global_size / env.size();
+  const uint64_t text_begin = slice_size * env.rank();
+  const uint64_t cap = max_lcp;
+  const auto owner = [&](const uint64_t index) {
+    return (slice_size == 0) ? uint64_t(env.size() - 1) :
+      std::min<uint64_t>(index / slice_size, env.size() - 1);
+  };
+  assert(local_text.const_local_data()->size() >= text_size + cap ||
+    env.rank() + 1 == env.size());
+
+  // Get the last suffix of the preceding processing element.
+  GlobalIndex prev_last_suffix = GlobalIndex(0);
+  GlobalIndex local_last_suffix = local_sa.local_size() > 0 ?
+    local_sa[local_sa.local_size() - 1] : GlobalIndex(0);
+  dpt::mpi::data_type_mapper<GlobalIndex> dtm;
+  MPI_Sendrecv(&local_last_suffix, 1, dtm.get_mpi_type(),
+    (env.rank() + 1 < env.size()) ? env.rank() + 1 : MPI_PROC_NULL, 0,
+    &prev_last_suffix, 1, dtm.get_mpi_type(),
+    (env.rank() > 0) ? env.rank() - 1 : MPI_PROC_NULL, 0,
+    env.communicator(), MPI_STATUS_IGNORE);
+
+  // Send (suffix, phi[suffix]) to the processing element containing suffix.
+  std::vector<size_t> hist(env.size(), 0);
+  for (size_t i = 0; i < local_sa.local_size(); ++i) {
+    ++hist[owner(local_sa[i])];
+  }
+  std::vector<size_t> counts(hist);
+  std::vector<size_t> start_pos(env.size(), 0);
+  for (int32_t i = 1; i < env.size(); ++i) {
+    start_pos[i] = start_pos[i - 1] + hist[i - 1];
+  }
+  std::vector<phi_tuple> phis(local_sa.local_size());
+  for (size_t i = 0; i < local_sa.local_size(); ++i) {
+    const GlobalIndex predecessor = (i > 0) ? local_sa[i - 1] :
+      prev_last_suffix;
+    phis[start_pos[owner(local_sa[i])]++] = phi_tuple { local_sa[i],
+      predecessor, (i > 0 || env.rank() > 0) };
+  }
+  std::vector<size_t> rec_counts;
+  std::vector<phi_tuple> rec_phis;
+  std::tie(rec_counts, rec_phis) = dpt::mpi::alltoallv_counts(phis, counts,
+    env);
+  std::vector<phi_tuple>().swap(phis);
+
+  std::vector<uint64_t> phi(text_size, 0);
+  std::vector<bool> has_phi(text_size, false);
+  for (const auto& rp : rec_phis) {
+    phi[uint64_t(rp.suffix) - text_begin] = rp.predecessor;
+    has_phi[uint64_t(rp.suffix) - text_begin] = rp.has_predecessor;
+  }
+
+  // Compute the PLCP-array in rounds. In each round, each undetermined entry
+  // requests (at most) round_length characters following the already matched
+  // prefix of its predecessor.
+  std::vector<uint64_t> plcp(text_size, 0);
+  std::vector<bool> determined(text_size, false);
+  for (uint64_t i = 0; i < text_size; ++i) {
+    determined[i] = !has_phi[i] || cap == 0;
+  }
+  const auto max_length = [&](const uint64_t i) {
+    return std::min(cap,
+      global_size - std::max(text_begin + i, phi[i]));
+  };
+  std::vector<bool>().swap(has_phi);
+
+  const auto local_chars = local_text.data_begin();
+  bool finished = false;
+  for (uint64_t round_length = 8; !finished; round_length <<= 1) {
+    std::vector<GlobalIndex> req_positions;
+    std::vector<LocalIndex> req_lengths;
+    std::vector<uint64_t> req_suffixes;
+    for (uint64_t i = 0; i < text_size; ++i) {
+      if (!determined[i]) {
+        if (i > 0 && determined[i - 1] && plcp[i - 1] > plcp[i] + 1) {
+          plcp[i] = plcp[i - 1] - 1;
+        }
+        if (plcp[i] >= max_length(i)) {
+          plcp[i] = max_length(i);
+          determined[i] = true;
+        } else {
+          req_positions.emplace_back(phi[i] + plcp[i]);
+          req_lengths.emplace_back(
+            std::min(round_length, max_length(i) - plcp[i]));
+          req_suffixes.emplace_back(i);
+        }
+      }
+    }
+    std::vector<LocalIndex> lengths(req_lengths);
+    auto substrings = manager.template request_substrings<Communication>(
+      req_positions, lengths);
+    for (size_t r = 0, substr_pos = 0; r < req_suffixes.size(); ++r) {
+      const uint64_t i = req_suffixes[r];
+      size_t pos = 0;
+      while (pos < req_lengths[r] && substrings[substr_pos + pos] ==
+        *(local_chars + i + plcp[i] + pos)) {
+        ++pos;
+      }
+      plcp[i] += pos;
+      determined[i] = (pos < req_lengths[r]) || (plcp[i] == max_length(i));
+      substr_pos += req_lengths[r];
+    }
+    bool locally_finished = std::all_of(determined.begin(), determined.end(),
+      [](const bool d) { return d; });
+    finished = dpt::mpi::allreduce_and(locally_finished, env);
+  }
+  std::vector<uint64_t>().swap(phi);
+
+  // Send the PLCP-values back (in the same order as the requests).
+  std::vector<GlobalIndex> response;
+  response.reserve(rec_phis.size());
+  for (const auto& rp : rec_phis) {
+    response.emplace_back(plcp[uint64_t(rp.suffix) - text_begin]);
+  }
+  std::vector<phi_tuple>().swap(rec_phis);
+  std::vector<GlobalIndex> rec_lcps = dpt::mpi::alltoallv(response, rec_counts,
+    env);
+
+  start_pos[0] = 0;
+  for (int32_t i = 1; i < env.size(); ++i) {
+    start_pos[i] = start_pos[i - 1] + counts[i - 1];
+  }
+  std::vector<GlobalIndex> lcp;
+  lcp.reserve(local_sa.local_size());
+  for (size_t i = 0; i < local_sa.local_size(); ++i) {
+    lcp.emplace_back(rec_lcps[start_pos[owner(local_sa[i])]++]);
+  }
+  return dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>(
+    GlobalIndex(local_sa.global_size()), GlobalIndex(local_sa.local_size()),
+    std::move(lcp), env);
+}
+
+} // namespace sa
+} // namespace dpt
+
+/******************************************************************************/
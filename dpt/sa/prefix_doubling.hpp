@@ -0,0 +1,223 @@
+/*******************************************************************************
+ * dpt/sa/prefix_doubling.hpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <mpi.h>
+#include <type_traits>
+#include <vector>
+
+#include "mpi/all_to_all.hpp"
+#include "mpi/allreduce.hpp"
+#include "mpi/environment.hpp"
+#include "mpi/sort.hpp"
+#include "mpi/type_mapper.hpp"
+#include "util/partition.hpp"
+
+namespace dpt {
+namespace sa {
+
+/// \brief Rank of a suffix and the rank of the suffix \e h positions further.
+///
+/// \tparam GlobalIndex Type of an index position on the global data.
+template <typename GlobalIndex>
+struct rank_tuple {
+  GlobalIndex rank;
+  GlobalIndex rank_next;
+  GlobalIndex index;
+
+  inline bool operator < (const rank_tuple& other) const {
+    if (rank != other.rank) {
+      return rank < other.rank;
+    } else if (rank_next != other.rank_next) {
+      return rank_next < other.rank_next;
+    }
+    return index < other.index;
+  }
+
+  inline bool same_name(const rank_tuple& other) const {
+    return rank == other.rank && rank_next == other.rank_next;
+  }
+} __attribute__ ((packed)); // struct rank_tuple
+
+/// \brief Tuple consisting of a (global) text position and a rank.
+///
+/// \tparam GlobalIndex Type of an index position on the global data.
+template <typename GlobalIndex>
+struct index_rank {
+  GlobalIndex index;
+  GlobalIndex rank;
+} __attribute__ ((packed)); // struct index_rank
+
+/// \brief Distributed suffix array construction using prefix doubling.
+///
+/// In each round, all suffixes are sorted (using a distributed sample sort) by
+/// the ranks of their first \e h and the following \e h characters. Then, the
+/// suffixes are renamed, i.e., each suffix gets the rank of the first suffix
+/// with the same prefix of length 2h. We stop as soon as all ranks are unique.
+/// The resulting suffix array is distributed the same way as
+/// \e dpt::mpi::distribute_file distributes a suffix array file.
+///
+/// \tparam Alphabet Type of the characters of the text.
+/// \tparam GlobalIndex Type of an index position on the global data.
+/// \tparam LocalIndex Type of an index position on the local data.
+/// \param local_text The local (partition) of the text.
+/// \returns The local slice of the suffix array of the text.
+template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
+dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex> prefix_doubling(
+  const dpt::util::partition<Alphabet, GlobalIndex, LocalIndex>& local_text) {
+
+  using tuple = rank_tuple<GlobalIndex>;
+  using idx_rank = index_rank<GlobalIndex>;
+  using unsigned_alphabet = typename std::make_unsigned<Alphabet>::type;
+
+  dpt::mpi::environment env = local_text.text_environment();
+  const uint64_t global_size = local_text.global_size();
+  const uint64_t local_size = local_text.local_size();
+  // Distributed like dpt::mpi::distribute_file: all but the last PE contain
+  // slice_size elements (which is 0 if there are fewer elements than PEs) and
+  // the last PE contains the remaining ones.
+  const uint64_t slice_size = global_size / env.size();
+  const uint64_t local_begin = slice_size * env.rank();
+  const auto owner = [&](const uint64_t index) {
+    return (slice_size == 0) ? uint64_t(env.size() - 1) :
+      std::min<uint64_t>(index / slice_size, env.size() - 1);
+  };
+
+  // Initially, the rank of a suffix is its first character (shifted by one, as
+  // rank 0 denotes suffixes beyond the end of the text).
+  std::vector<GlobalIndex> ranks;
+  ranks.reserve(local_size);
+  for (uint64_t i = 0; i < local_size; ++i) {
+    ranks.emplace_back(static_cast<uint64_t>(
+      static_cast<unsigned_alphabet>(local_text[i])) + 1);
+  }
+
+  std::vector<tuple> tuples;
+  for (uint64_t h = 1; true; h <<= 1) {
+    // Send the rank of each suffix i to the PE containing suffix i - h. As the
+    // positions are consecutive, the requests are already sorted by target PE.
+    std::vector<size_t> send_counts(env.size(), 0);
+    std::vector<idx_rank> next_ranks;
+    for (uint64_t i = std::max(local_begin, h); i < local_begin + local_size;
+      ++i) {
+      ++send_counts[owner(i - h)];
+      next_ranks.emplace_back(
+        idx_rank { GlobalIndex(i - h), ranks[i - local_begin] });
+    }
+    next_ranks = dpt::mpi::alltoallv(next_ranks, send_counts, env);
+
+    tuples.clear();
+    tuples.reserve(local_size);
+    for (uint64_t i = 0; i < local_size; ++i) {
+      tuples.emplace_back(
+        tuple { ranks[i], GlobalIndex(0), GlobalIndex(local_begin + i) });
+    }
+    std::vector<GlobalIndex>().swap(ranks);
+    for (const auto& nr : next_ranks) {
+      tuples[uint64_t(nr.index) - local_begin].rank_next = nr.rank;
+    }
+    std::vector<idx_rank>().swap(next_ranks);
+
+    dpt::mpi::sample_sort(tuples, std::less<tuple>(), env);
+
+    // Compute the global position of the first local tuple and find the last
+    // tuple of the preceding PEs (to check if our first tuple is a new name).
+    uint64_t nr_tuples = tuples.size();
+    uint64_t tuples_before = 0;
+    MPI_Exscan(&nr_tuples, &tuples_before, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+      env.communicator());
+    if (env.rank() == 0) {
+      tuples_before = 0;
+    }
+    std::vector<uint8_t> has_tuples(env.size(), 0);
+    uint8_t local_has_tuples = (nr_tuples > 0);
+    MPI_Allgather(&local_has_tuples, 1, MPI_BYTE, has_tuples.data(), 1,
+      MPI_BYTE, env.communicator());
+    tuple local_last = (nr_tuples > 0) ? tuples.back() : tuple();
+    std::vector<tuple> last_tuples(env.size());
+    dpt::mpi::data_type_mapper<tuple> dtm;
+    MPI_Allgather(&local_last, 1, dtm.get_mpi_type(), last_tuples.data(), 1,
+      dtm.get_mpi_type(), env.communicator());
+    int32_t prev_pe = env.rank() - 1;
+    while (prev_pe >= 0 && !has_tuples[prev_pe]) {
+      --prev_pe;
+    }
+
+    // Rename: the new rank of a tuple is the (1-based) global position of the
+    // first tuple with the same name. Names spanning PEs are resolved using the
+    // maximum head position of all preceding PEs.
+    std::vector<GlobalIndex> names(nr_tuples);
+    bool all_unique = true;
+    uint64_t last_head = 0;
+    for (uint64_t i = 0; i < nr_tuples; ++i) {
+      const bool is_head = (i > 0) ? !tuples[i].same_name(tuples[i - 1]) :
+        (prev_pe < 0 || !tuples[i].same_name(last_tuples[prev_pe]));
+      if (is_head) {
+        last_head = tuples_before + i + 1;
+      } else {
+        all_unique = false;
+      }
+      names[i] = last_head;
+    }
+    uint64_t prev_head = 0;
+    MPI_Exscan(&last_head, &prev_head, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX,
+      env.communicator());
+    if (env.rank() == 0) {
+      prev_head = 0;
+    }
+    for (uint64_t i = 0; i < nr_tuples && uint64_t(names[i]) == 0; ++i) {
+      names[i] = prev_head;
+    }
+
+    if (dpt::mpi::allreduce_and(all_unique, env)) {
+      // All suffixes are sorted. Redistribute them such that each PE holds the
+      // same slice of the suffix array as when reading it from a file.
+      std::vector<size_t> sa_counts(env.size(), 0);
+      std::vector<GlobalIndex> sa;
+      sa.reserve(nr_tuples);
+      for (uint64_t i = 0; i < nr_tuples; ++i) {
+        ++sa_counts[owner(tuples_before + i)];
+        sa.push_back(tuples[i].index);
+      }
+      std::vector<tuple>().swap(tuples);
+      sa = dpt::mpi::alltoallv(sa, sa_counts, env);
+      return dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>(
+        GlobalIndex(global_size), GlobalIndex(local_size), std::move(sa), env);
+    }
+
+    // Send the new names back to the PEs containing the suffixes.
+    std::vector<size_t> name_counts(env.size(), 0);
+    for (const auto& t : tuples) {
+      ++name_counts[owner(t.index)];
+    }
+    std::vector<size_t> name_displ(env.size(), 0);
+    for (int32_t i = 1; i < env.size(); ++i) {
+      name_displ[i] = name_displ[i - 1] + name_counts[i - 1];
+    }
+    std::vector<idx_rank> new_names(nr_tuples);
+    for (uint64_t i = 0; i < nr_tuples; ++i) {
+      new_names[name_displ[owner(tuples[i].index)]++] =
+        idx_rank { tuples[i].index, names[i] };
+    }
+    std::vector<GlobalIndex>().swap(names);
+    new_names = dpt::mpi::alltoallv(new_names, name_counts, env);
+    ranks.resize(local_size);
+    for (const auto& nn : new_names) {
+      ranks[uint64_t(nn.index) - local_begin] = nn.rank;
+    }
+  }
+}
+
+} // namespace sa
+} // namespace dpt
+
+/******************************************************************************/
@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * dpt/tree/child_search.hpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef DPT_TREE_CHILD_SEARCH_HEADER
+#define DPT_TREE_CHILD_SEARCH_HEADER
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace dpt {
+namespace tree {
+
+/// \brief Finds the first of the (sorted) labels of the children of a node
+///        that is not smaller than \e character.
+///
+/// For single byte alphabets, the labels are compared in blocks of 32 (AVX2)
+/// or 16 (SSE2) characters, i.e., a vector compare and a movemask replace up
+/// to 32 scalar comparisons. Only complete blocks within the labels are read,
+/// the remaining labels are compared one by one.
+///
+/// \tparam Alphabet Type of the labels.
+/// \param labels Pointer to the label of the first child.
+/// \param nr_children Number of children (labels).
+/// \param character Character that is searched.
+/// \returns The number of the first child whose label is not smaller than
+///          \e character (or \e nr_children if there is no such child).
+template <typename Alphabet>
+inline size_t child_lower_bound(const Alphabet* labels,
+  const size_t nr_children, const Alphabet character) {
+  size_t child = 0;
+#if defined(__SSE2__)
+  if constexpr (sizeof(Alphabet) == 1) {
+    // The vector instructions compare signed bytes, hence unsigned labels are
+    // shifted by flipping their most significant bit.
+    const char flip = std::is_signed<Alphabet>::value ? 0 : char(0x80);
+    const auto bytes = reinterpret_cast<const char*>(labels);
+    const char searched = char(character) ^ flip;
+#if defined(__AVX2__)
+    const __m256i flip_256 = _mm256_set1_epi8(flip);
+    const __m256i searched_256 = _mm256_set1_epi8(searched);
+    for (; child + 32 <= nr_children; child += 32) {
+      const __m256i block = _mm256_xor_si256(flip_256, _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(bytes + child)));
+      const uint32_t smaller = _mm256_movemask_epi8(
+        _mm256_cmpgt_epi8(searched_256, block));
+      if (smaller != 0xFFFFFFFF) {
+        return child + __builtin_ctz(~smaller);
+      }
+    }
+#endif
+    const __m128i flip_128 = _mm_set1_epi8(flip);
+    const __m128i searched_128 = _mm_set1_epi8(searched);
+    for (; child + 16 <= nr_children; child += 16) {
+      const __m128i block = _mm_xor_si128(flip_128, _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(bytes + child)));
+      const uint32_t smaller = _mm_movemask_epi8(
+        _mm_cmpgt_epi8(searched_128, block));
+      if (smaller != 0xFFFF) {
+        return child + __builtin_ctz(~smaller);
+      }
+    }
+  }
+#endif
+  while (child < nr_children && labels[child] < character) {
+    ++child;
+  }
+  return child;
+}
+
+/// \brief Direct-indexed table containing the result of \e child_lower_bound
+///        for every character of a single byte alphabet, i.e., the child of
+///        the node the table is built for is found with one lookup. The
+///        table has 256 entries of two bytes. For larger alphabets, the table
+///        is not \e available and must not be used.
+///
+/// \tparam Alphabet Type of the labels.
+template <typename Alphabet>
+class child_jump_table {
+
+public:
+  static constexpr bool available = (sizeof(Alphabet) == 1);
+
+  /// \param labels Pointer to the label of the first child.
+  /// \param nr_children Number of children (labels).
+  void build(const Alphabet* labels, const size_t nr_children) {
+    if constexpr (available) {
+      for (size_t character = 0; character < table_.size(); ++character) {
+        table_[character] = child_lower_bound(labels, nr_children,
+          Alphabet(character));
+      }
+    }
+  }
+
+  /// \returns The same value as \e child_lower_bound for \e character.
+  inline size_t operator [] (const Alphabet character) const {
+    if constexpr (available) {
+      return table_[static_cast<std::make_unsigned_t<Alphabet>>(character)];
+    } else {
+      return 0;
+    }
+  }
+
+private:
+  std::array<uint16_t, available ? 256 : 0> table_;
+
+}; // class child_jump_table
+
+} // namespace tree
+} // namespace dpt
+
+#endif // DPT_TREE_CHILD_SEARCH_HEADER
+
+/******************************************************************************/
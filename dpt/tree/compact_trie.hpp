@@ -10,8 +10,12 @@
 
 #pragma once
 
+#include <cassert>
+#include <vector>
+
 #include "query/query_view.hpp"
 #include "tree/search_result.hpp"
+#include "util/serialization.hpp"
 
 namespace dpt {
 namespace tree {
@@ -37,7 +41,53 @@ public:
   }
 
   inline search_result<uint32_t> first_occurrence(const query_view& query) const {
-    const auto result = trie_.first_occurrence(query);
+    return outside_of_text(trie_.first_occurrence(query));
+  }
+
+  inline search_result_pair<uint32_t>first_and_last_occurrence(
+    const query_view& query) const {
+    return outside_of_text(trie_.first_and_last_occurrence(query));
+  }
+
+  /// \brief Computes \e first_occurrence for the queries [\e begin, \e end)
+  ///        (searched interleaved) and stores the results at the same
+  ///        positions in \e results.
+  template <typename Queries>
+  void first_occurrence_batched(const Queries& queries, const size_t begin,
+    const size_t end, std::vector<search_result<uint32_t>>& results) const {
+    trie_.first_occurrence_batched(queries, begin, end, results);
+    for (size_t i = begin; i < end; ++i) {
+      results[i] = outside_of_text(results[i]);
+    }
+  }
+
+  /// \brief Computes \e first_and_last_occurrence for the queries
+  ///        [\e begin, \e end) (searched interleaved) and stores the results
+  ///        at the same positions in \e results.
+  template <typename Queries>
+  void first_and_last_occurrence_batched(const Queries& queries,
+    const size_t begin, const size_t end,
+    std::vector<search_result_pair<uint32_t>>& results) const {
+    trie_.first_and_last_occurrence_batched(queries, begin, end, results);
+    for (size_t i = begin; i < end; ++i) {
+      results[i] = outside_of_text(results[i]);
+    }
+  }
+
+  void save(dpt::util::index_writer& writer) const {
+    trie_.save(writer);
+  }
+
+  bool load(dpt::util::index_reader& reader) {
+    return trie_.load(reader);
+  }
+
+private:
+  /// \returns NO_MATCH if the query is lexicographically smaller than the
+  ///          first suffix (or larger than the last suffix) of a PE and the
+  ///          result of the search otherwise.
+  static search_result<uint32_t> outside_of_text(
+    const search_result<uint32_t>& result) {
     if ((result.state == search_state::LEFT_OF && !(result.position & 1UL)) ||
       (result.state == search_state::RIGHT_OF && (result.position & 1UL))) {
       return { search_state::NO_MATCH, 0 };
@@ -45,9 +95,8 @@ public:
     return result;
   }
 
-  inline search_result_pair<uint32_t>first_and_last_occurrence(
-    const query_view& query) const {
-    const auto result = trie_.first_and_last_occurrence(query);
+  static search_result_pair<uint32_t> outside_of_text(
+    const search_result_pair<uint32_t>& result) {
     if ((result.state == search_state::LEFT_OF && 
       !(result.left_position & 1UL)) ||
       (result.state == search_state::RIGHT_OF &&
@@ -58,7 +107,6 @@ public:
     return result;
   }
 
-private:
   CompactTrieStructure<Alphabet, GlobalIndex, LocalIndex> trie_;
 
 }; // class compact_trie
@@ -10,19 +10,34 @@
 
 #pragma once
 
+#include <array>
+#include <type_traits>
+#include <vector>
+
 #include "com/manager.hpp"
 #include "query/query_view.hpp"
+#include "tree/child_search.hpp"
+#include "tree/node_layout.hpp"
+#include "tree/node_storage.hpp"
 #include "tree/pointer_node.hpp"
 #include "tree/search_result.hpp"
 #include "util/partition.hpp"
+#include "util/serialization.hpp"
 
 namespace dpt {
 namespace tree {
 
-template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
+/// \tparam LeafRanges If \e true, each node stores the leftmost and rightmost
+///         leaf of its subtrie (see \e ranged_trie_node), i.e., the leaves
+///         of a search result are found without descending to them.
+/// \tparam NodeStorage Layout of the nodes: \e packed_nodes (array of
+///         structures) or \e split_nodes (structure of arrays).
+template <typename Alphabet, typename GlobalIndex, typename LocalIndex,
+          bool LeafRanges = false,
+          template <typename> class NodeStorage = packed_nodes>
 class compact_trie_pointer {
 
-  using node = trie_node<Alphabet, LocalIndex>;
+  using node = select_trie_node<Alphabet, LocalIndex, LeafRanges>;
   using manager = dpt::com::manager<Alphabet, GlobalIndex, LocalIndex>;
   using partition = dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>;
   using query_view = dpt::query::query_view<Alphabet, LocalIndex>;
@@ -35,7 +50,7 @@ public:
     return node { 0, root_.node_begin };
   }
 
-  inline Alphabet out_degree(const node& n) const {
+  inline node_degree<Alphabet> out_degree(const node& n) const {
     return nodes_[n.position].out_degree;
   }
 
@@ -63,12 +78,12 @@ public:
 
     struct stack_element {
       LocalIndex lcp;
-      Alphabet nr_children;
+      node_degree<Alphabet> nr_children;
       GlobalIndex node_buffer_pos;
       GlobalIndex text_buffer_pos;
 
       stack_element () = default;
-      stack_element (const LocalIndex _lcp, const Alphabet nr_chld,
+      stack_element (const LocalIndex _lcp, const node_degree<Alphabet> nr_chld,
                      const GlobalIndex node_pos, const GlobalIndex txt_pos)
         : lcp(_lcp), nr_children(nr_chld), node_buffer_pos(node_pos),
           text_buffer_pos(txt_pos) { }
@@ -168,117 +183,110 @@ public:
     std::tie(first_characters_, labels_) = 
       manager.template
         request_substrings_head<Communication>(requests, lengths);
+    if constexpr (LeafRanges) {
+      compute_leaf_ranges(nodes_, root_);
+    }
+    relayout();
+  }
+
+  /// \brief Renumbers the nodes in blocked breadth-first order (see
+  ///        \e blocked_bfs_order) and moves their labels accordingly. This is
+  ///        done after the construction, where the nodes are in post-order.
+  ///
+  /// \param block_size Number of nodes per block (default: one page).
+  void relayout(const size_t block_size = default_block_size) {
+    const auto new_positions = blocked_bfs_order(nodes_, root_, block_size);
+    reorder_nodes(nodes_, root_, new_positions);
+    std::vector<LocalIndex> old_positions(new_positions.size());
+    for (size_t pos = 0; pos < new_positions.size(); ++pos) {
+      old_positions[new_positions[pos]] = pos;
+    }
+    std::vector<Alphabet> first_characters(first_characters_.size());
+    std::vector<Alphabet> labels;
+    std::vector<LocalIndex> labels_starting_positions = { 0 };
+    labels.reserve(labels_.size());
+    labels_starting_positions.reserve(labels_starting_positions_.size());
+    for (size_t pos = 0; pos < old_positions.size(); ++pos) {
+      const LocalIndex old_pos = old_positions[pos];
+      first_characters[pos] = first_characters_[old_pos];
+      std::copy(labels_.begin() + labels_starting_positions_[old_pos],
+        labels_.begin() + labels_starting_positions_[old_pos + 1],
+        std::back_inserter(labels));
+      labels_starting_positions.emplace_back(labels.size());
+    }
+    first_characters_ = std::move(first_characters);
+    labels_ = std::move(labels);
+    labels_starting_positions_ = std::move(labels_starting_positions);
+    build_root_table();
   }
 
   inline search_result<uint32_t> first_occurrence(const query_view& query) const {
     auto cur_node = root_;
-    while (cur_node.out_degree > 0 && cur_node.string_depth < query.length) {
-      Alphabet child_pos = 0;
-      while (child_pos < cur_node.out_degree &&
-        first_characters_[cur_node.edge_begin + child_pos] <
-        query[cur_node.string_depth]) {
-        ++child_pos;
-      }
-      if (child_pos == cur_node.out_degree) {
-        return { search_state::RIGHT_OF, rightmost_leaf(
-            nodes_[cur_node.edge_begin + child_pos - 1]).edge_begin };
-      }
-      else if (first_characters_[cur_node.edge_begin + child_pos] >
-        query[cur_node.string_depth]) {
-        return { search_state::LEFT_OF,
-          leftmost_leaf(
-            nodes_[cur_node.edge_begin + child_pos]).edge_begin };
-      } else /*(first_chrs[cur_node.edge_begin + child_pos] == query[q_pos])*/ {
-        LocalIndex q_pos = cur_node.string_depth + 1;
-        LocalIndex e_pos = 
-          labels_starting_positions_[cur_node.edge_begin + child_pos];
-        while (q_pos < query.length && e_pos <
-          labels_starting_positions_[cur_node.edge_begin + child_pos + 1] &&
-          labels_[e_pos] == query[q_pos]) {
-          ++e_pos;
-          ++q_pos;
-        }
-        if (e_pos ==
-          labels_starting_positions_[cur_node.edge_begin + child_pos + 1]) {
-          cur_node = nodes_[cur_node.edge_begin + child_pos];
-        } else if (q_pos == query.length) {
-          return { search_state::MATCH,
-            leftmost_leaf(nodes_[cur_node.edge_begin + child_pos]).edge_begin };
-        } else if (e_pos >
-          labels_starting_positions_[cur_node.edge_begin + child_pos + 1]) {
-          return { search_state::LEFT_OF,
-            leftmost_leaf(nodes_[cur_node.edge_begin + child_pos]).edge_begin };
-        } else if (e_pos <
-          labels_starting_positions_[cur_node.edge_begin + child_pos + 1]) {
-          return { search_state::RIGHT_OF,
-            rightmost_leaf(
-              nodes_[cur_node.edge_begin + child_pos]).edge_begin };
-        }
-      }
+    search_state state;
+    if (!search_step(query, cur_node, state, true)) {
+      while (!search_step(query, cur_node, state)) { }
     }
-    return { search_state::MATCH, cur_node.edge_begin };
+    return first_occurrence_result(state, cur_node);
   }
 
   inline search_result_pair<uint32_t> first_and_last_occurrence(
     const query_view& query) const {
     auto cur_node = root_;
-    while (cur_node.out_degree > 0 && cur_node.string_depth < query.length) {
-      Alphabet child_pos = 0;
-      while (child_pos < cur_node.out_degree &&
-        first_characters_[cur_node.edge_begin + child_pos] <
-        query[cur_node.string_depth]) {
-        ++child_pos;
-      }
-      if (child_pos == cur_node.out_degree) {
-        const auto rightmost = rightmost_leaf(nodes_[
-          cur_node.edge_begin + child_pos - 1]).edge_begin;
-        return { search_state::RIGHT_OF, rightmost, rightmost };
-      }
-      else if (first_characters_[cur_node.edge_begin + child_pos] >
-        query[cur_node.string_depth]) {
-        const auto leftmost = leftmost_leaf(nodes_[
-          cur_node.edge_begin + child_pos]).edge_begin;
-        return { search_state::LEFT_OF, leftmost, leftmost };
-      } else /*(first_chrs[cur_node.edge_begin + child_pos] == query[q_pos])*/ {
-        LocalIndex q_pos = cur_node.string_depth + 1;
-        LocalIndex e_pos =
-          labels_starting_positions_[cur_node.edge_begin + child_pos];
-        while (q_pos < query.length && e_pos <
-          labels_starting_positions_[cur_node.edge_begin + child_pos + 1] &&
-          labels_[e_pos] == query[q_pos]) {
-          ++e_pos;
-          ++q_pos;
-        }
-        if (e_pos ==
-          labels_starting_positions_[cur_node.edge_begin + child_pos + 1]) {
-          cur_node = nodes_[cur_node.edge_begin + child_pos];
-        } else if (q_pos == query.length) {
-          return { search_state::MATCH,
-            leftmost_leaf(nodes_[cur_node.edge_begin + child_pos]).edge_begin,
-            rightmost_leaf(nodes_[
-              cur_node.edge_begin + child_pos]).edge_begin };
-        } else if (e_pos >
-          labels_starting_positions_[cur_node.edge_begin + child_pos + 1]) {
-          const auto leftmost = leftmost_leaf(nodes_[
-          cur_node.edge_begin + child_pos]).edge_begin;
-          return { search_state::LEFT_OF, leftmost, leftmost };
-        } else if (e_pos <
-          labels_starting_positions_[cur_node.edge_begin + child_pos + 1]) {
-          const auto rightmost = rightmost_leaf(nodes_[
-          cur_node.edge_begin + child_pos - 1]).edge_begin;
-          return { search_state::RIGHT_OF, rightmost, rightmost };
-        }
-      }
-    }
-    if (cur_node.out_degree == 0) {
-      return{ search_state::MATCH, cur_node.edge_begin, cur_node.edge_begin };
-    } else {
-      return{ search_state::MATCH, leftmost_leaf(cur_node).edge_begin,
-        rightmost_leaf(cur_node).edge_begin };
+    search_state state;
+    if (!search_step(query, cur_node, state, true)) {
+      while (!search_step(query, cur_node, state)) { }
     }
+    return first_and_last_occurrence_result(state, cur_node);
+  }
+
+  /// \brief Computes \e first_occurrence for the queries [\e begin, \e end)
+  ///        and stores the results at the same positions in \e results.
+  template <typename Queries>
+  void first_occurrence_batched(const Queries& queries, const size_t begin,
+    const size_t end, std::vector<search_result<uint32_t>>& results) const {
+    search_interleaved(queries, begin, end,
+      [&](const size_t i, const search_state state, const node& end_node) {
+        results[i] = first_occurrence_result(state, end_node);
+      });
+  }
+
+  /// \brief Computes \e first_and_last_occurrence for the queries
+  ///        [\e begin, \e end) and stores the results at the same positions in
+  ///        \e results.
+  template <typename Queries>
+  void first_and_last_occurrence_batched(const Queries& queries,
+    const size_t begin, const size_t end,
+    std::vector<search_result_pair<uint32_t>>& results) const {
+    search_interleaved(queries, begin, end,
+      [&](const size_t i, const search_state state, const node& end_node) {
+        results[i] = first_and_last_occurrence_result(state, end_node);
+      });
+  }
+
+  void save(dpt::util::index_writer& writer) const {
+    writer.write(first_characters_);
+    writer.write(labels_);
+    writer.write(labels_starting_positions_);
+    nodes_.save(writer);
+    writer.write(root_);
+  }
+
+  bool load(dpt::util::index_reader& reader) {
+    const bool success = reader.read(first_characters_) &&
+      reader.read(labels_) && reader.read(labels_starting_positions_) &&
+      nodes_.load(reader) && reader.read(root_);
+    build_root_table();
+    return success;
   }
 
 private:
+  /// \brief Builds the jump table for the children of the root (if the
+  ///        alphabet is small enough).
+  void build_root_table() {
+    root_table_.build(first_characters_.data() + root_.edge_begin,
+      root_.out_degree);
+  }
+
   template <typename Iterator>
   inline bool update_check_iterators(GlobalIndex& prev_sa, GlobalIndex& cur_sa,
     GlobalIndex& prev_lcp, GlobalIndex& cur_lcp, Iterator& sa_iterator,
@@ -293,6 +301,134 @@ private:
     return true;
   }
 
+  /// \brief Descends one node of the trie, i.e., compares the query with the
+  ///        label of the matching child of \e cur_node.
+  ///
+  /// \returns \e false if the whole label matches, then \e cur_node is set to
+  ///          the child. Otherwise, the search ends: \e state is set to the
+  ///          final state and \e cur_node to the node whose leftmost (MATCH,
+  ///          LEFT_OF) or rightmost (RIGHT_OF) leaf is the result.
+  ///
+  /// \param at_root \e true if \e cur_node is the root. Then, the child is
+  ///        looked up in the jump table of the root (if available).
+  inline bool search_step(const query_view& query, node& cur_node,
+    search_state& state, const bool at_root = false) const {
+    if (cur_node.out_degree == 0 || cur_node.string_depth >= query.length) {
+      state = search_state::MATCH;
+      return true;
+    }
+    const size_t degree = cur_node.out_degree;
+    const size_t child_pos =
+      (child_jump_table<Alphabet>::available && at_root) ?
+      root_table_[query[cur_node.string_depth]] : child_lower_bound(
+        first_characters_.data() + cur_node.edge_begin, degree,
+        query[cur_node.string_depth]);
+    if (child_pos == degree) {
+      state = search_state::RIGHT_OF;
+      cur_node = nodes_[cur_node.edge_begin + child_pos - 1];
+      return true;
+    } else if (first_characters_[cur_node.edge_begin + child_pos] >
+      query[cur_node.string_depth]) {
+      state = search_state::LEFT_OF;
+      cur_node = nodes_[cur_node.edge_begin + child_pos];
+      return true;
+    }
+    LocalIndex q_pos = cur_node.string_depth + 1;
+    LocalIndex e_pos =
+      labels_starting_positions_[cur_node.edge_begin + child_pos];
+    const LocalIndex e_end =
+      labels_starting_positions_[cur_node.edge_begin + child_pos + 1];
+    while (q_pos < query.length && e_pos < e_end &&
+      labels_[e_pos] == query[q_pos]) {
+      ++e_pos;
+      ++q_pos;
+    }
+    cur_node = nodes_[cur_node.edge_begin + child_pos];
+    if (e_pos == e_end) {
+      return false;
+    } else if (q_pos == query.length) {
+      state = search_state::MATCH;
+    } else if (query[q_pos] < labels_[e_pos]) {
+      state = search_state::LEFT_OF;
+    } else {
+      state = search_state::RIGHT_OF;
+    }
+    return true;
+  }
+
+  inline search_result<uint32_t> first_occurrence_result(
+    const search_state state, const node& end_node) const {
+    if (state == search_state::RIGHT_OF) {
+      return { state, static_cast<uint32_t>(rightmost_leaf(end_node)) };
+    }
+    return { state, static_cast<uint32_t>(leftmost_leaf(end_node)) };
+  }
+
+  inline search_result_pair<uint32_t> first_and_last_occurrence_result(
+    const search_state state, const node& end_node) const {
+    if (state == search_state::MATCH) {
+      return { state, static_cast<uint32_t>(leftmost_leaf(end_node)),
+        static_cast<uint32_t>(rightmost_leaf(end_node)) };
+    }
+    const auto position = first_occurrence_result(state, end_node).position;
+    return { state, position, position };
+  }
+
+  /// \brief Searches the queries [\e begin, \e end) interleaved: up to
+  ///        \e interleaved_queries queries are in flight. Each round advances
+  ///        every query in flight by one node and prefetches the children of
+  ///        its next node, such that the cache misses of different queries
+  ///        overlap. Finished queries are replaced by the next query.
+  ///
+  /// \param report Function called with the index of the query, the final
+  ///        state and the final node (see \e search_step) of each query.
+  template <typename Queries, typename Report>
+  void search_interleaved(const Queries& queries, const size_t begin,
+    const size_t end, Report report) const {
+    struct query_in_flight {
+      size_t query;
+      node cur_node;
+      bool at_root;
+    }; // struct query_in_flight
+
+    std::array<query_in_flight, interleaved_queries> in_flight;
+    size_t nr_in_flight = 0;
+    size_t next_query = begin;
+    while (nr_in_flight < interleaved_queries && next_query < end) {
+      in_flight[nr_in_flight++] = { next_query++, root_, true };
+    }
+    while (nr_in_flight > 0) {
+      for (size_t slot = 0; slot < nr_in_flight;) {
+        auto& cur = in_flight[slot];
+        search_state state;
+        if (!search_step(queries[cur.query], cur.cur_node, state,
+          cur.at_root)) {
+          cur.at_root = false;
+          prefetch_children(cur.cur_node);
+          ++slot;
+        } else {
+          report(cur.query, state, cur.cur_node);
+          if (next_query < end) {
+            cur = { next_query++, root_, true };
+            ++slot;
+          } else {
+            cur = in_flight[--nr_in_flight];
+          }
+        }
+      }
+    }
+  }
+
+  /// \brief Prefetches the data accessed when descending from \e cur_node.
+  inline void prefetch_children(const node& cur_node) const {
+    if (cur_node.out_degree > 0) {
+      __builtin_prefetch(first_characters_.data() + cur_node.edge_begin);
+      __builtin_prefetch(labels_starting_positions_.data() +
+        cur_node.edge_begin);
+      nodes_.prefetch(cur_node.edge_begin);
+    }
+  }
+
   inline int32_t compare_edge(LocalIndex label_begin, LocalIndex& query_begin,
     const LocalIndex label_length, const query_view& query) const {
     const LocalIndex comparison_length = std::min(
@@ -307,29 +443,56 @@ private:
     return 0;
   }
 
-  inline node leftmost_leaf(node cur_edge) const {
-    while (cur_edge.out_degree > 0) {
-      cur_edge = nodes_[cur_edge.edge_begin];
+  /// \returns The position of the leftmost leaf below \e cur_edge.
+  inline LocalIndex leftmost_leaf(node cur_edge) const {
+    if constexpr (LeafRanges) {
+      return cur_edge.leftmost_leaf;
+    } else {
+      while (cur_edge.out_degree > 0) {
+        cur_edge = nodes_[cur_edge.edge_begin];
+      }
+      return cur_edge.edge_begin;
     }
-    return cur_edge;
   }
 
-  inline node rightmost_leaf(node cur_edge) const {
-    while (cur_edge.out_degree > 0) {
-      cur_edge = nodes_[cur_edge.edge_begin + cur_edge.out_degree - 1];
+  /// \returns The position of the rightmost leaf below \e cur_edge.
+  inline LocalIndex rightmost_leaf(node cur_edge) const {
+    if constexpr (LeafRanges) {
+      return cur_edge.rightmost_leaf;
+    } else {
+      while (cur_edge.out_degree > 0) {
+        cur_edge = nodes_[cur_edge.edge_begin + cur_edge.out_degree - 1];
+      }
+      return cur_edge.edge_begin;
     }
-    return cur_edge;
   }
 
 private:
+  /// Number of queries that are searched interleaved.
+  static constexpr size_t interleaved_queries = 16;
+  /// Number of nodes that fit into one page.
+  static constexpr size_t default_block_size = 4096 / sizeof(node);
+
   std::vector<Alphabet> first_characters_;
   std::vector<Alphabet> labels_;
   std::vector<LocalIndex> labels_starting_positions_;
-  std::vector<node> nodes_;
+  NodeStorage<node> nodes_;
   node root_;
+  // Lower bounds of all characters among the children of the root.
+  child_jump_table<Alphabet> root_table_;
 
 }; // class compact_trie_pointer
 
+/// \brief \e compact_trie_pointer whose nodes store their leaf intervals.
+template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
+using compact_trie_pointer_leaf_ranges = compact_trie_pointer<Alphabet,
+  GlobalIndex, LocalIndex, true>;
+
+/// \brief \e compact_trie_pointer that stores its nodes as structure of arrays.
+template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
+using compact_trie_pointer_split = compact_trie_pointer<Alphabet, GlobalIndex,
+  LocalIndex, false, split_nodes>;
+
 } // namespace tree
 } // namespace dpt
 
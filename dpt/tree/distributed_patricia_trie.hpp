@@ -10,13 +10,30 @@
 
 #pragma once
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "mpi/all_to_all.hpp"
+#include "mpi/allreduce.hpp"
 #include "mpi/environment.hpp"
+#include "com/collective.hpp"
 #include "com/manager.hpp"
 #include "mpi/io.hpp"
 #include "query/query_list.hpp"
+#include "sa/phi_lcp.hpp"
+#include "sa/prefix_doubling.hpp"
 #include "tree/compact_trie.hpp"
 #include "tree/patricia_trie.hpp"
 #include "tree/search_result.hpp"
+#include "util/lru_cache.hpp"
+#include "util/parallel.hpp"
+#include "util/serialization.hpp"
 
 namespace dpt {
 namespace tree {
@@ -38,6 +55,12 @@ class distributed_patricia_trie {
 public:
   distributed_patricia_trie() { }
 
+  /// \param text_path Path to the text.
+  /// \param sa_path Path to the suffix array of the text. If empty, the suffix
+  ///        array is computed (distributed and in memory) during construction.
+  /// \param lcp_path Path to the LCP-array of the text. If empty, the
+  ///        LCP-array is computed from the suffix array during construction.
+  /// \param max_query_length Maximum length of a query.
   distributed_patricia_trie(const std::string& text_path,
     const std::string& sa_path, const std::string& lcp_path,
     const GlobalIndex max_query_length) : manager_(
@@ -46,11 +69,23 @@ public:
       sa_path_(sa_path), lcp_path_(lcp_path),
       max_query_length_(max_query_length) { }
 
+  /// \param text_path Path to the text. Suffix and LCP-array are computed
+  ///        during construction.
+  /// \param max_query_length Maximum length of a query.
+  distributed_patricia_trie(const std::string& text_path,
+    const GlobalIndex max_query_length)
+  : distributed_patricia_trie(text_path, "", "", max_query_length) { }
+
+  /// \param nr_threads Number of threads used (per PE) to build the local
+  ///        Patricia trie.
   template <template <typename, typename, typename> class GlobalCommunication,
             template <typename, typename, typename> class LocalCommunication>
-  void construct() {
+  void construct(const size_t nr_threads = 1) {
+    clear_caches();
+    prepare_communication<GlobalCommunication>();
+    prepare_communication<LocalCommunication>();
     construct_local_trie<LocalCommunication>(sa_path_, lcp_path_,
-      max_query_length_);
+      max_query_length_, nr_threads);
     std::vector<GlobalIndex> global_sa;
     std::vector<GlobalIndex> global_lcp;
     auto local_global = local_trie_.global_sa_and_lcp();
@@ -60,149 +95,575 @@ public:
       global_sa, global_lcp, max_query_length_);
   }
 
-  template <template <typename, typename, typename> class Communication>
-  auto existential_batched(q_list&& queries) {
-    std::vector<size_t> hist(env_.size(), 0);
-    std::vector<size_t> hist_length(env_.size(), 0);
-    std::vector<int32_t> target_pes(queries.size());
-    for (size_t i = 0; i < queries.size(); ++i) {
-      const auto result = global_trie_.first_occurrence(queries[i]);
-      if (result.state == search_state::MATCH) {
-        target_pes[i] = (result.position >> 1);
-        ++hist[target_pes[i]];
-        hist_length[target_pes[i]] += queries[i].length;
-      } else {
-        target_pes[i] = -1;
-      }
+  /// \brief Writes the constructed index to disk. Each PE writes its part of
+  ///        the index (local text, local suffix array, local and global trie)
+  ///        to the file \e index_path.rank.
+  ///
+  /// \param index_path Path (prefix) of the index files.
+  /// \returns \e true if all PEs have written their files successfully.
+  bool save(const std::string& index_path) {
+    dpt::util::index_writer writer(index_path + "." +
+      std::to_string(env_.rank()));
+    writer.write(index_magic);
+    writer.write(uint64_t(sizeof(Alphabet)));
+    writer.write(uint64_t(sizeof(GlobalIndex)));
+    writer.write(uint64_t(sizeof(LocalIndex)));
+    writer.write(env_.size());
+    writer.write(max_query_length_);
+    manager_.save(writer);
+    local_trie_.save(writer);
+    global_trie_.save(writer);
+    bool success = writer.good();
+    return dpt::mpi::allreduce_and(success, env_);
+  }
+
+  /// \brief Loads an index written by \e save (using the same number of PEs
+  ///        and types). The file is mapped into memory and the local text,
+  ///        the local suffix array, and the nodes and labels of the local trie
+  ///        are views of the mapping, i.e., their pages are only read from
+  ///        disk when they are accessed. No text, suffix or LCP-array has to
+  ///        be read, no trie has to be built, and no communication is
+  ///        required.
+  ///
+  /// \tparam Communication Type of (MPI) communication used for queries. The
+  ///         window of one-sided communication is created here, otherwise by
+  ///         the first one-sided query.
+  /// \param index_path Path (prefix) of the index files.
+  /// \returns \e true if all PEs have loaded their files successfully.
+  template <template <typename, typename, typename> class Communication =
+    dpt::com::collective_communication>
+  bool load(const std::string& index_path) {
+    clear_caches();
+    manager_.free_text_window();
+    dpt::util::index_reader reader(index_path + "." +
+      std::to_string(env_.rank()));
+    uint64_t magic = 0;
+    uint64_t alphabet_size = 0;
+    uint64_t global_index_size = 0;
+    uint64_t local_index_size = 0;
+    int32_t nr_pes = 0;
+    bool success = reader.read(magic) && magic == index_magic &&
+      reader.read(alphabet_size) && alphabet_size == sizeof(Alphabet) &&
+      reader.read(global_index_size) &&
+      global_index_size == sizeof(GlobalIndex) &&
+      reader.read(local_index_size) &&
+      local_index_size == sizeof(LocalIndex) &&
+      reader.read(nr_pes) && nr_pes == env_.size() &&
+      reader.read(max_query_length_) && manager_.load(reader) &&
+      local_trie_.load(reader) && global_trie_.load(reader) &&
+      reader.finished();
+    success = dpt::mpi::allreduce_and(success, env_);
+    if (success) {
+      prepare_communication<Communication>();
     }
-    std::vector<GlobalIndex> displ(env_.size(), 0);
-    std::vector<GlobalIndex> displ_length(env_.size(), 0);
-    for (int32_t i = 1; i < env_.size(); ++i) {
-      displ[i] = displ[i - 1] + hist[i - 1];
-      displ_length[i] = displ_length[i - 1] + hist_length[i - 1];
+    return success;
+  }
+
+  /// \brief Sets the number of results of existential and counting queries
+  ///        that are cached (each) on this PE. Queries found in the cache are
+  ///        answered without communication. A capacity of 0 disables the
+  ///        caches (default).
+  void set_cache_capacity(const size_t capacity) {
+    existential_cache_.resize(capacity);
+    counting_cache_.resize(capacity);
+  }
+
+  /// \returns The cache of the results of existential queries.
+  inline const dpt::util::lru_cache<search_state>& existential_cache() const {
+    return existential_cache_;
+  }
+
+  /// \returns The cache of the results of counting queries.
+  inline const dpt::util::lru_cache<GlobalIndex>& counting_cache() const {
+    return counting_cache_;
+  }
+
+  /// \param batch Batch of queries of this PE.
+  /// \param nr_threads Number of threads used (per PE) to route the queries
+  ///        and to answer them in the local trie.
+  /// \returns For each query of the batch (in the same order) whether it
+  ///          occurs in the text.
+  template <template <typename, typename, typename> class Communication>
+  std::vector<search_state> existential_batched(q_list&& batch,
+    const size_t nr_threads = 1) {
+    prepare_communication<Communication>();
+    // Identical queries are only routed and answered once and cached queries
+    // are not routed at all.
+    q_list distinct;
+    std::vector<size_t> representatives;
+    std::tie(distinct, representatives) = batch.distinct();
+    std::vector<search_state> results(distinct.size(),
+      search_state::NO_MATCH);
+    std::vector<size_t> uncached;
+    q_list queries = cache_lookup(existential_cache_, std::move(distinct),
+      results, uncached);
+    std::vector<std::pair<int32_t, int32_t>> target_pes(queries.size());
+    std::vector<search_result<uint32_t>> global_results(queries.size());
+    dpt::util::parallel_blocks(queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        global_trie_.first_occurrence_batched(queries, begin, end,
+          global_results);
+        for (size_t i = begin; i < end; ++i) {
+          const auto& result = global_results[i];
+          // The query can only occur on the PE found in the global trie.
+          const int32_t target_pe = (result.state != search_state::NO_MATCH) ?
+            int32_t(result.position >> 1) : -1;
+          target_pes[i] = std::make_pair(target_pe, target_pe);
+        }
+      });
+    routing route = route_queries<Communication>(queries, target_pes,
+      nr_threads);
+    auto local_results = local_trie_.template existential_batched<
+      Communication>(std::move(route.rec_queries), manager_, nr_threads);
+    auto answers = dpt::mpi::alltoallv(local_results, route.rec_counts, env_);
+
+    for (size_t slot = 0; slot < answers.size(); ++slot) {
+      results[uncached[route.slot_queries[slot]]] = answers[slot];
     }
-    std::vector<Alphabet> queries_to_distribute(
-      displ_length.back() + hist_length.back());
-    std::vector<LocalIndex> lengths_to_distribute(queries.size());
+    cache_insert(existential_cache_, queries, results, uncached);
+    return fan_out(results, representatives);
+  }
+
+  /// \param batch Batch of queries of this PE.
+  /// \param nr_threads Number of threads used (per PE) to route the queries
+  ///        and to answer them in the local trie.
+  /// \returns For each query of the batch (in the same order) the number of
+  ///          its occurrences.
+  ///
+  /// The queries are only sent to the PEs containing the first and the last
+  /// occurrence. There, the local counts are the number of occurrences from
+  /// the first occurrence to the end of the local slice of the suffix array
+  /// and from the beginning of the local slice to the last occurrence,
+  /// respectively. All suffixes on the PEs in between are occurrences, too.
+  template <template <typename, typename, typename> class Communication>
+  std::vector<GlobalIndex> counting_batched(q_list&& batch,
+    const size_t nr_threads = 1) {
+    prepare_communication<Communication>();
+    // Identical queries are only routed and answered once and cached queries
+    // are not routed at all.
+    q_list distinct;
+    std::vector<size_t> representatives;
+    std::tie(distinct, representatives) = batch.distinct();
+    std::vector<GlobalIndex> results(distinct.size(), GlobalIndex(0));
+    std::vector<size_t> uncached;
+    q_list queries = cache_lookup(counting_cache_, std::move(distinct),
+      results, uncached);
+    const auto target_pes = first_and_last_target_pes(queries, nr_threads);
+    routing route = route_queries<Communication>(queries, target_pes,
+      nr_threads);
+    auto local_results = local_trie_.template counting_batched<Communication>(
+      std::move(route.rec_queries), manager_, nr_threads);
+    auto answers = dpt::mpi::alltoallv(local_results, route.rec_counts, env_);
+
+    // All but the last PE contain slice_size entries of the suffix array and
+    // the last PE can only be the PE of the last occurrence.
+    const uint64_t slice_size =
+      manager_.local_text().global_size() / env_.size();
     for (size_t i = 0; i < queries.size(); ++i) {
-      if (target_pes[i] >= 0) {
-        std::copy_n(queries[i].query, queries[i].length, 
-          queries_to_distribute.begin() + displ_length[target_pes[i]]);
-        displ_length[target_pes[i]] += queries[i].length;
+      if (target_pes[i].second > target_pes[i].first + 1) {
+        results[uncached[i]] = GlobalIndex(slice_size *
+          (target_pes[i].second - target_pes[i].first - 1));
       }
     }
-    q_list rec_queries = manager_.template distribute_queries<Communication>(
-      queries_to_distribute, lengths_to_distribute, hist_length, hist);
-    return local_trie_.template existential_batched<Communication>(
-      std::move(rec_queries), manager_);
+    for (size_t slot = 0; slot < answers.size(); ++slot) {
+      results[uncached[route.slot_queries[slot]]] +=
+        GlobalIndex(answers[slot]);
+    }
+    cache_insert(counting_cache_, queries, results, uncached);
+    return fan_out(results, representatives);
   }
 
+  /// \param batch Batch of queries of this PE.
+  /// \param nr_threads Number of threads used (per PE) to route the queries
+  ///        and to answer them in the local trie.
+  /// \param limit Maximum number of occurrences reported per query. Only the
+  ///        first \e limit occurrences (in suffix array order) are reported.
+  /// \returns The occurrences of all queries of the batch (concatenated in
+  ///          the same order as the queries) and the number of reported
+  ///          occurrences of each query.
+  ///
+  /// The queries are only sent to (and verified on) the PEs containing the
+  /// first and the last occurrence. All PEs in between only receive a quota
+  /// for each query whose occurrences cover their whole local slice of the
+  /// suffix array and send back the first \e quota entries of their slice.
+  /// The quotas are computed once the PE of the first occurrence has reported
+  /// its number of occurrences (at most \e limit), i.e., a PE in between is
+  /// only asked for the occurrences that the PE of the first occurrence and
+  /// the preceding PEs in between cannot provide. The PE of the last
+  /// occurrence is only asked if the PEs in between cannot provide \e limit
+  /// occurrences.
   template <template <typename, typename, typename> class Communication>
-  auto counting_batched(q_list&& queries) {
-    std::vector<size_t> hist(env_.size(), 0);
-    std::vector<size_t> hist_length(env_.size(), 0);
-    std::vector<std::pair<int32_t, int32_t>> target_pes(queries.size());
+  std::pair<std::vector<GlobalIndex>, std::vector<GlobalIndex>>
+    enumeration_batched(q_list&& batch, const size_t nr_threads = 1,
+    const size_t limit = std::numeric_limits<size_t>::max()) {
+    prepare_communication<Communication>();
+    // Identical queries are only routed and answered once.
+    q_list queries;
+    std::vector<size_t> representatives;
+    std::tie(queries, representatives) = batch.distinct();
+    // All but the last PE contain slice_size entries of the suffix array and
+    // the last PE can only be the PE of the last occurrence.
+    const uint64_t slice_size =
+      manager_.local_text().global_size() / env_.size();
+
+    // The query is not sent to the PE of the last occurrence if the PEs in
+    // between can provide \e limit occurrences. The PEs in between are still
+    // determined by the PE of the last occurrence (see \e target_pes).
+    const auto target_pes = first_and_last_target_pes(queries, nr_threads);
+    auto route_pes = target_pes;
     for (size_t i = 0; i < queries.size(); ++i) {
-      const auto result = global_trie_.first_and_last_occurrence(queries[i]);
-      if (result.state == search_state::MATCH) {
-        target_pes[i] = std::make_pair(result.left_position >> 1,
-          result.right_position >> 1);
-        ++hist[target_pes[i].first];
-        hist_length[target_pes[i].first] += queries[i].length;
-        if (target_pes[i].first != target_pes[i].second) {
-          ++hist[target_pes[i].second];
-          hist_length[target_pes[i].second] += queries[i].length;
+      const uint64_t nr_between = (target_pes[i].second > target_pes[i].first) ?
+        target_pes[i].second - target_pes[i].first - 1 : 0;
+      if (nr_between > 0 && nr_between * slice_size >= limit) {
+        route_pes[i].second = route_pes[i].first;
+      }
+    }
+
+    routing route = route_queries<Communication>(queries, route_pes,
+      nr_threads);
+    std::vector<GlobalIndex> local_occurrences;
+    std::vector<LocalIndex> local_sizes;
+    std::tie(local_occurrences, local_sizes) =
+      local_trie_.template enumeration_batched<Communication>(
+        std::move(route.rec_queries), manager_, nr_threads, limit);
+    auto answer_sizes = dpt::mpi::alltoallv(local_sizes, route.rec_counts,
+      env_);
+
+    // Number of occurrences reported by the PE of the first occurrence.
+    std::vector<uint64_t> first_counts(queries.size(), 0);
+    for (int32_t pe = 0, slot = 0; pe < env_.size(); ++pe) {
+      for (size_t i = 0; i < route.send_counts[pe]; ++i, ++slot) {
+        if (target_pes[route.slot_queries[slot]].first == pe) {
+          first_counts[route.slot_queries[slot]] = answer_sizes[slot];
         }
-      } else {
-        target_pes[i] = std::make_pair(-1, -1);
       }
     }
-    std::vector<GlobalIndex> displ(env_.size(), 0);
-    std::vector<GlobalIndex> displ_length(env_.size(), 0);
-    for (int32_t i = 1; i < env_.size(); ++i) {
-      displ[i] = displ[i - 1] + hist[i - 1];
-      displ_length[i] = displ_length[i - 1] + hist_length[i - 1];
+
+    // For each PE, the queries (in the order of the batch) whose occurrences
+    // contain the PE's whole slice of the suffix array and their quotas, i.e.,
+    // the number of occurrences that are still missing after the PE of the
+    // first occurrence and all preceding PEs in between.
+    std::vector<std::vector<size_t>> slice_queries(env_.size());
+    std::vector<std::vector<size_t>> pe_slice_quotas(env_.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+      uint64_t requested = first_counts[i];
+      for (int32_t pe = target_pes[i].first + 1;
+        pe < target_pes[i].second && requested < limit; ++pe) {
+        const uint64_t quota = std::min<uint64_t>(slice_size,
+          limit - requested);
+        slice_queries[pe].emplace_back(i);
+        pe_slice_quotas[pe].emplace_back(quota);
+        requested += quota;
+      }
+    }
+    std::vector<size_t> slice_counts(env_.size(), 0);
+    std::vector<size_t> slice_quotas;
+    for (int32_t pe = 0; pe < env_.size(); ++pe) {
+      slice_counts[pe] = slice_queries[pe].size();
+      slice_quotas.insert(slice_quotas.end(), pe_slice_quotas[pe].begin(),
+        pe_slice_quotas[pe].end());
+    }
+    std::vector<size_t> rec_slice_counts;
+    std::vector<size_t> rec_slice_quotas;
+    std::tie(rec_slice_counts, rec_slice_quotas) =
+      dpt::mpi::alltoallv_counts(slice_quotas, slice_counts, env_);
+
+    // The answers for each PE are the occurrences of its queries followed by
+    // the requested prefixes of the local slice of the suffix array.
+    const auto& local_sa = local_trie_.local_sa();
+    std::vector<size_t> answer_counts(env_.size(), 0);
+    std::vector<GlobalIndex> answers_to_send;
+    answers_to_send.reserve(local_occurrences.size() + std::accumulate(
+      rec_slice_quotas.begin(), rec_slice_quotas.end(), size_t(0)));
+    size_t slot = 0;
+    size_t occ_pos = 0;
+    size_t quota_pos = 0;
+    for (int32_t pe = 0; pe < env_.size(); ++pe) {
+      for (size_t i = 0; i < route.rec_counts[pe]; ++i) {
+        answers_to_send.insert(answers_to_send.end(),
+          local_occurrences.begin() + occ_pos,
+          local_occurrences.begin() + occ_pos + local_sizes[slot]);
+        answer_counts[pe] += local_sizes[slot];
+        occ_pos += local_sizes[slot++];
+      }
+      for (size_t i = 0; i < rec_slice_counts[pe]; ++i) {
+        const size_t quota = rec_slice_quotas[quota_pos++];
+        answers_to_send.insert(answers_to_send.end(), local_sa.data_begin(),
+          local_sa.data_begin() + quota);
+        answer_counts[pe] += quota;
+      }
+    }
+    std::vector<GlobalIndex>().swap(local_occurrences);
+    auto answers = dpt::mpi::alltoallv(answers_to_send, answer_counts, env_);
+
+    // The answers are received in the order of the PEs, i.e., in the order
+    // of the suffix array. Hence, appending them (until the limit is reached)
+    // yields the first occurrences of each query in suffix array order.
+    std::vector<size_t> received(queries.size(), 0);
+    for (size_t slot = 0; slot < answer_sizes.size(); ++slot) {
+      received[route.slot_queries[slot]] += answer_sizes[slot];
     }
-    std::vector<Alphabet> queries_to_distribute(
-      displ_length.back() + hist_length.back());
-    std::vector<LocalIndex> lengths_to_distribute(queries.size());
+    quota_pos = 0;
+    for (int32_t pe = 0; pe < env_.size(); ++pe) {
+      for (const size_t query : slice_queries[pe]) {
+        received[query] += slice_quotas[quota_pos++];
+      }
+    }
+    std::vector<GlobalIndex> sizes(queries.size());
+    std::vector<size_t> positions(queries.size() + 1, 0);
     for (size_t i = 0; i < queries.size(); ++i) {
-      if (target_pes[i].first >= 0) {
-        std::copy_n(queries[i].query, queries[i].length, 
-          queries_to_distribute.begin() + displ_length[target_pes[i].first]);
-        displ_length[target_pes[i].first] += queries[i].length;
-        if (target_pes[i].first != target_pes[i].second) {
-          std::copy_n(queries[i].query, queries[i].length, 
-            queries_to_distribute.begin() + displ_length[target_pes[i].second]);
-          displ_length[target_pes[i].second] += queries[i].length;
-        }
+      sizes[i] = GlobalIndex(std::min<size_t>(received[i], limit));
+      positions[i + 1] = positions[i] + uint64_t(sizes[i]);
+    }
+    std::vector<GlobalIndex> occurrences(positions.back());
+    std::fill(received.begin(), received.end(), 0);
+    const auto append = [&](const size_t query, const size_t answer_pos,
+      const size_t answer_size) {
+      const size_t nr_copied = std::min<size_t>(answer_size,
+        uint64_t(sizes[query]) - received[query]);
+      std::copy_n(answers.begin() + answer_pos, nr_copied,
+        occurrences.begin() + positions[query] + received[query]);
+      received[query] += nr_copied;
+    };
+    slot = 0;
+    quota_pos = 0;
+    size_t answer_pos = 0;
+    for (int32_t pe = 0; pe < env_.size(); ++pe) {
+      for (size_t i = 0; i < route.send_counts[pe]; ++i, ++slot) {
+        append(route.slot_queries[slot], answer_pos, answer_sizes[slot]);
+        answer_pos += answer_sizes[slot];
+      }
+      for (const size_t query : slice_queries[pe]) {
+        append(query, answer_pos, slice_quotas[quota_pos]);
+        answer_pos += slice_quotas[quota_pos++];
       }
     }
-    q_list rec_queries = manager_.template distribute_queries<Communication>(
-      queries_to_distribute, lengths_to_distribute, hist_length, hist);
-    return local_trie_.template counting_batched<Communication>(
-      std::move(rec_queries), manager_);
+
+    // Copy the occurrences of each distinct query to all its duplicates.
+    std::vector<GlobalIndex> batch_sizes = fan_out(sizes, representatives);
+    std::vector<GlobalIndex> batch_occurrences;
+    batch_occurrences.reserve(std::accumulate(batch_sizes.begin(),
+      batch_sizes.end(), uint64_t(0), [](const uint64_t sum,
+        const GlobalIndex size) { return sum + uint64_t(size); }));
+    for (const size_t query : representatives) {
+      batch_occurrences.insert(batch_occurrences.end(),
+        occurrences.begin() + positions[query],
+        occurrences.begin() + positions[query + 1]);
+    }
+    return std::make_pair(batch_occurrences, batch_sizes);
+  }
+
+private:
+  /// \returns For each query of a batch the result of its representative
+  ///          among the distinct queries of the batch.
+  template <typename Result>
+  static std::vector<Result> fan_out(const std::vector<Result>& results,
+    const std::vector<size_t>& representatives) {
+    std::vector<Result> batch_results;
+    batch_results.reserve(representatives.size());
+    for (const size_t query : representatives) {
+      batch_results.emplace_back(results[query]);
+    }
+    return batch_results;
   }
 
+  /// \brief Creates the window exposing the local text if \e Communication
+  ///        uses one-sided communication and the window does not exist yet.
+  ///        This is a collective operation, hence, it is called at the
+  ///        beginning of all (collective) construction, loading and query
+  ///        functions.
   template <template <typename, typename, typename> class Communication>
-  auto enumeration_batched(q_list&& queries) {
-    std::vector<size_t> hist(env_.size(), 0);
-    std::vector<size_t> hist_length(env_.size(), 0);
-    std::vector<std::pair<int32_t, int32_t>> target_pes(queries.size());
+  void prepare_communication() {
+    if constexpr (Communication<Alphabet, GlobalIndex, LocalIndex>
+      ::remote_memory_access) {
+      manager_.create_text_window();
+    }
+  }
+
+  /// \brief Removes all cached results, which belong to the previous index.
+  void clear_caches() {
+    existential_cache_.clear();
+    counting_cache_.clear();
+  }
+
+  /// \returns The key of a query in the caches, i.e., its bytes.
+  static std::string_view cache_key(
+    const dpt::query::query_view<Alphabet, LocalIndex>& query) {
+    return std::string_view(reinterpret_cast<const char*>(query.query),
+      query.length * sizeof(Alphabet));
+  }
+
+  /// \brief Looks up the (distinct) queries in the cache and sets the results
+  ///        of all cached queries.
+  ///
+  /// \param uncached Set to the indices of all queries that are not cached.
+  /// \returns The queries that are not cached.
+  template <typename Result>
+  static q_list cache_lookup(dpt::util::lru_cache<Result>& cache,
+    q_list&& queries, std::vector<Result>& results,
+    std::vector<size_t>& uncached) {
+    uncached.clear();
+    if (cache.capacity() == 0) {
+      for (size_t i = 0; i < queries.size(); ++i) {
+        uncached.emplace_back(i);
+      }
+      return std::move(queries);
+    }
+    std::vector<Alphabet> uncached_queries;
+    std::vector<LocalIndex> uncached_lengths;
     for (size_t i = 0; i < queries.size(); ++i) {
-      const auto result = global_trie_.first_and_last_occurrence(queries[i]);
-      if (result.state == search_state::MATCH) {
-        target_pes[i] = std::make_pair(result.left_position >> 1,
-          result.right_position >> 1);
-        ++hist[target_pes[i].first];
-        hist_length[target_pes[i].first] += queries[i].length;
-        if (target_pes[i].first != target_pes[i].second) {
-          ++hist[target_pes[i].second];
-          hist_length[target_pes[i].second] += queries[i].length;
-        }
+      const Result* cached = cache.find(cache_key(queries[i]));
+      if (cached != nullptr) {
+        results[i] = *cached;
       } else {
-        target_pes[i] = std::make_pair(-1, -1);
+        std::copy_n(queries[i].query, queries[i].length,
+          std::back_inserter(uncached_queries));
+        uncached_lengths.emplace_back(queries[i].length);
+        uncached.emplace_back(i);
       }
     }
-    std::vector<GlobalIndex> displ(env_.size(), 0);
-    std::vector<GlobalIndex> displ_length(env_.size(), 0);
-    for (int32_t i = 1; i < env_.size(); ++i) {
-      displ[i] = displ[i - 1] + hist[i - 1];
-      displ_length[i] = displ_length[i - 1] + hist_length[i - 1];
+    return q_list(std::move(uncached_queries), std::move(uncached_lengths));
+  }
+
+  /// \brief Caches the results of the queries returned by \e cache_lookup.
+  template <typename Result>
+  static void cache_insert(dpt::util::lru_cache<Result>& cache,
+    const q_list& queries, const std::vector<Result>& results,
+    const std::vector<size_t>& uncached) {
+    if (cache.capacity() > 0) {
+      for (size_t i = 0; i < queries.size(); ++i) {
+        cache.insert(cache_key(queries[i]), results[uncached[i]]);
+      }
     }
-    std::vector<Alphabet> queries_to_distribute(
-      displ_length.back() + hist_length.back());
-    std::vector<LocalIndex> lengths_to_distribute(queries.size());
-    for (size_t i = 0; i < queries.size(); ++i) {
+  }
+
+  /// \brief Queries received by this PE and the information required to send
+  ///        the answers back to the PEs that submitted the queries.
+  struct routing {
+    /// Queries received by this PE (grouped by the submitting PE).
+    q_list rec_queries;
+    /// Number of queries received from each PE.
+    std::vector<size_t> rec_counts;
+    /// Number of queries sent to each PE.
+    std::vector<size_t> send_counts;
+    /// Index (in the batch) of the query sent at each position of the send
+    /// buffer, i.e., the answer received at position \e i belongs to query
+    /// \e slot_queries[i].
+    std::vector<size_t> slot_queries;
+  }; // struct routing
+
+  /// \returns For each query the PEs containing its first and last occurrence
+  ///          according to the global trie (or -1 if it cannot occur).
+  std::vector<std::pair<int32_t, int32_t>> first_and_last_target_pes(
+    const q_list& queries, const size_t nr_threads) const {
+    std::vector<std::pair<int32_t, int32_t>> target_pes(queries.size());
+    std::vector<search_result_pair<uint32_t>> global_results(queries.size());
+    dpt::util::parallel_blocks(queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        global_trie_.first_and_last_occurrence_batched(queries, begin, end,
+          global_results);
+        for (size_t i = begin; i < end; ++i) {
+          const auto& result = global_results[i];
+          if (result.state != search_state::NO_MATCH) {
+            target_pes[i] = std::make_pair(result.left_position >> 1,
+              result.right_position >> 1);
+          } else {
+            target_pes[i] = std::make_pair(-1, -1);
+          }
+        }
+      });
+    return target_pes;
+  }
+
+  /// \brief Sends each query to the first and (if different) the second PE of
+  ///        its target pair. Queries without target (-1) are not sent. Each
+  ///        thread copies a block of queries into the send buffer, the
+  ///        queries of each PE remain in the order of the batch.
+  template <template <typename, typename, typename> class Communication>
+  routing route_queries(const q_list& queries,
+    const std::vector<std::pair<int32_t, int32_t>>& target_pes,
+    const size_t nr_threads) {
+    const size_t nr_blocks = dpt::util::nr_parallel_blocks(nr_threads);
+    const auto for_each_target = [&](const size_t i, auto function) {
       if (target_pes[i].first >= 0) {
-        std::copy_n(queries[i].query, queries[i].length, 
-          queries_to_distribute.begin() + displ_length[target_pes[i].first]);
-        displ_length[target_pes[i].first] += queries[i].length;
-        if (target_pes[i].first != target_pes[i].second) {
-          std::copy_n(queries[i].query, queries[i].length, 
-            queries_to_distribute.begin() + displ_length[target_pes[i].second]);
-          displ_length[target_pes[i].second] += queries[i].length;
+        function(target_pes[i].first);
+        if (target_pes[i].second != target_pes[i].first) {
+          function(target_pes[i].second);
         }
       }
+    };
+
+    std::vector<std::vector<size_t>> block_hist(nr_blocks,
+      std::vector<size_t>(env_.size(), 0));
+    std::vector<std::vector<size_t>> block_hist_length(block_hist);
+    dpt::util::parallel_blocks(queries.size(), nr_blocks,
+      [&](const size_t block, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          for_each_target(i, [&](const int32_t target_pe) {
+            ++block_hist[block][target_pe];
+            block_hist_length[block][target_pe] += queries[i].length;
+          });
+        }
+      });
+
+    // Each block writes its queries for PE i behind the queries of all
+    // previous blocks for PE i.
+    std::vector<size_t> hist(env_.size(), 0);
+    std::vector<size_t> hist_length(env_.size(), 0);
+    std::vector<std::vector<size_t>> displ(block_hist);
+    std::vector<std::vector<size_t>> displ_length(block_hist_length);
+    size_t offset = 0;
+    size_t offset_length = 0;
+    for (int32_t pe = 0; pe < env_.size(); ++pe) {
+      for (size_t block = 0; block < nr_blocks; ++block) {
+        displ[block][pe] = offset;
+        displ_length[block][pe] = offset_length;
+        offset += block_hist[block][pe];
+        offset_length += block_hist_length[block][pe];
+        hist[pe] += block_hist[block][pe];
+        hist_length[pe] += block_hist_length[block][pe];
+      }
     }
-    q_list rec_queries = manager_.template distribute_queries<Communication>(
+    routing route;
+    route.slot_queries.resize(offset);
+    std::vector<Alphabet> queries_to_distribute(offset_length);
+    std::vector<LocalIndex> lengths_to_distribute(offset);
+    dpt::util::parallel_blocks(queries.size(), nr_blocks,
+      [&](const size_t block, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          for_each_target(i, [&](const int32_t target_pe) {
+            std::copy_n(queries[i].query, queries[i].length,
+              queries_to_distribute.begin() +
+              displ_length[block][target_pe]);
+            displ_length[block][target_pe] += queries[i].length;
+            route.slot_queries[displ[block][target_pe]] = i;
+            lengths_to_distribute[displ[block][target_pe]++] =
+              queries[i].length;
+          });
+        }
+      });
+    route.send_counts = hist;
+    route.rec_counts = dpt::mpi::alltoall(hist, env_);
+    route.rec_queries = manager_.template distribute_queries<Communication>(
       queries_to_distribute, lengths_to_distribute, hist_length, hist);
-    return local_trie_.template enumeration_batched<Communication>(
-      std::move(rec_queries), manager_);
+    return route;
   }
 
-private:
   template <template <typename, typename, typename> class Communication>
   inline void construct_local_trie(const std::string& sa_path,
-    const std::string& lcp_path, const GlobalIndex max_query_length) {
-    auto local_sa =
+    const std::string& lcp_path, const GlobalIndex max_query_length,
+    const size_t nr_threads) {
+    auto local_sa = sa_path.empty() ?
+      dpt::sa::prefix_doubling(manager_.local_text()) :
       dpt::mpi::distribute_file<GlobalIndex, GlobalIndex, LocalIndex>(
         sa_path, 0);
-    auto local_lcp =
+    auto local_lcp = lcp_path.empty() ?
+      dpt::sa::phi_lcp<Communication>(local_sa, manager_, max_query_length) :
       dpt::mpi::distribute_file<GlobalIndex, GlobalIndex, LocalIndex>(
         lcp_path, 0);
     local_trie_.template construct<Communication>(
-      std::move(local_sa), std::move(local_lcp), manager_, max_query_length);
+      std::move(local_sa), std::move(local_lcp), manager_, max_query_length,
+      nr_threads);
   }
 
   template <template <typename, typename, typename> class Communication>
@@ -214,10 +675,14 @@ private:
   }
 
 private:
+  static constexpr uint64_t index_magic = 0x3230544E49545044ULL; // "DPTINT02"
+
   dpt::mpi::environment env_;
   manager manager_;
   com_trie global_trie_;
   pat_trie local_trie_;
+  dpt::util::lru_cache<search_state> existential_cache_;
+  dpt::util::lru_cache<GlobalIndex> counting_cache_;
 
   std::string text_path_;
   std::string sa_path_;
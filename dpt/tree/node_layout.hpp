@@ -0,0 +1,104 @@
+/*******************************************************************************
+ * dpt/tree/node_layout.hpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef DPT_TREE_NODE_LAYOUT_HEADER
+#define DPT_TREE_NODE_LAYOUT_HEADER
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace dpt {
+namespace tree {
+
+/// \brief Computes a blocked breadth-first order of the nodes of a pointer
+///        trie. The children of a node remain contiguous (and in the same
+///        order). Starting at the children of \e root, the sibling groups are
+///        visited breadth-first until a block contains at least
+///        \e block_size nodes. The sibling groups that did not fit into the
+///        block start their own blocks, which are placed (recursively)
+///        directly after the block, i.e., the blocks are in depth-first order.
+///        Hence, the top of each subtrie shares a few pages instead of being
+///        scattered over the whole array, as in the post-order of the
+///        construction. If \e block_size is at least the number of nodes, the
+///        order is the plain breadth-first order.
+///
+/// \param nodes The nodes (without the root) of the trie.
+/// \param root The root of the trie.
+/// \param block_size Number of nodes per block.
+/// \returns The new position of each node.
+template <typename Nodes, typename Node>
+std::vector<decltype(Node::edge_begin)> blocked_bfs_order(const Nodes& nodes,
+  const Node& root, const size_t block_size) {
+  using index_type = decltype(Node::edge_begin);
+
+  std::vector<index_type> new_positions(nodes.size());
+  index_type next_position = 0;
+  // Parents (their first child and degree) of the groups starting a block.
+  std::vector<std::pair<index_type, size_t>> block_starts;
+  if (root.out_degree > 0) {
+    block_starts.emplace_back(root.edge_begin, root.out_degree);
+  }
+  std::deque<std::pair<index_type, size_t>> groups;
+  while (!block_starts.empty()) {
+    groups.emplace_back(block_starts.back());
+    block_starts.pop_back();
+    size_t block_nodes = 0;
+    while (!groups.empty() && (block_nodes == 0 || block_nodes < block_size)) {
+      const auto group = groups.front();
+      groups.pop_front();
+      for (size_t child = 0; child < group.second; ++child) {
+        new_positions[group.first + child] = next_position++;
+        const Node child_node = nodes[group.first + child];
+        if (child_node.out_degree > 0) {
+          groups.emplace_back(child_node.edge_begin, child_node.out_degree);
+        }
+      }
+      block_nodes += group.second;
+    }
+    // The remaining groups are placed in order after the block.
+    while (!groups.empty()) {
+      block_starts.emplace_back(groups.back());
+      groups.pop_back();
+    }
+  }
+  return new_positions;
+}
+
+/// \brief Moves each node to its new position and updates the pointers to
+///        the children of the inner nodes (and of \e root) accordingly.
+///
+/// \param new_positions New position of each node, the children of a node
+///        have to remain contiguous (see \e blocked_bfs_order).
+template <typename Nodes, typename Node>
+void reorder_nodes(Nodes& nodes, Node& root,
+  const std::vector<decltype(Node::edge_begin)>& new_positions) {
+  Nodes reordered;
+  reordered.resize(nodes.size());
+  for (size_t pos = 0; pos < nodes.size(); ++pos) {
+    Node cur_node = nodes[pos];
+    if (cur_node.out_degree > 0) {
+      cur_node.edge_begin = new_positions[cur_node.edge_begin];
+    }
+    reordered.set(new_positions[pos], cur_node);
+  }
+  if (root.out_degree > 0) {
+    root.edge_begin = new_positions[root.edge_begin];
+  }
+  nodes = std::move(reordered);
+}
+
+} // namespace tree
+} // namespace dpt
+
+#endif // DPT_TREE_NODE_LAYOUT_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,163 @@
+/*******************************************************************************
+ * dpt/tree/node_storage.hpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef DPT_TREE_NODE_STORAGE_HEADER
+#define DPT_TREE_NODE_STORAGE_HEADER
+
+#include <vector>
+
+#include "tree/pointer_node.hpp"
+#include "util/mapped_vector.hpp"
+#include "util/serialization.hpp"
+
+namespace dpt {
+namespace tree {
+
+/// \brief Stores the nodes of a pointer trie as one array of (packed) nodes,
+///        i.e., all fields of a node share the same cache line. Loaded nodes
+///        are a view of the mapped index file.
+///
+/// \tparam Node Type of the nodes (\e trie_node or \e ranged_trie_node).
+template <typename Node>
+class packed_nodes {
+
+public:
+  using value_type = Node;
+
+  inline size_t size() const {
+    return nodes_.size();
+  }
+
+  inline Node operator [] (const size_t pos) const {
+    return nodes_[pos];
+  }
+
+  inline void set(const size_t pos, const Node& n) {
+    nodes_.vector()[pos] = n;
+  }
+
+  inline void push_back(const Node& n) {
+    nodes_.vector().push_back(n);
+  }
+
+  void resize(const size_t size) {
+    nodes_.vector().resize(size);
+  }
+
+  /// \brief Prefetches the node at position \e pos.
+  inline void prefetch(const size_t pos) const {
+    __builtin_prefetch(nodes_.data() + pos);
+  }
+
+  void save(dpt::util::index_writer& writer) const {
+    writer.write(nodes_);
+  }
+
+  bool load(dpt::util::index_reader& reader) {
+    return reader.read(nodes_);
+  }
+
+private:
+  dpt::util::mapped_vector<Node> nodes_;
+
+}; // class packed_nodes
+
+/// \brief Stores the nodes of a pointer trie as structure of arrays, i.e.,
+///        there is one (aligned) array per field of the nodes. Nodes are
+///        assembled when they are accessed. Loaded arrays are views of the
+///        mapped index file.
+///
+/// \tparam Node Type of the nodes (\e trie_node or \e ranged_trie_node).
+template <typename Node>
+class split_nodes {
+
+  using depth_type = decltype(Node::string_depth);
+  using degree_type = decltype(Node::out_degree);
+  using index_type = decltype(Node::edge_begin);
+
+public:
+  using value_type = Node;
+
+  inline size_t size() const {
+    return string_depths_.size();
+  }
+
+  inline Node operator [] (const size_t pos) const {
+    Node n(string_depths_[pos], out_degrees_[pos], edge_begins_[pos]);
+    if constexpr (stores_leaf_ranges<Node>::value) {
+      n.leftmost_leaf = leftmost_leaves_[pos];
+      n.rightmost_leaf = rightmost_leaves_[pos];
+    }
+    return n;
+  }
+
+  inline void set(const size_t pos, const Node& n) {
+    string_depths_.vector()[pos] = n.string_depth;
+    out_degrees_.vector()[pos] = n.out_degree;
+    edge_begins_.vector()[pos] = n.edge_begin;
+    if constexpr (stores_leaf_ranges<Node>::value) {
+      leftmost_leaves_.vector()[pos] = n.leftmost_leaf;
+      rightmost_leaves_.vector()[pos] = n.rightmost_leaf;
+    }
+  }
+
+  inline void push_back(const Node& n) {
+    resize(size() + 1);
+    set(size() - 1, n);
+  }
+
+  void resize(const size_t size) {
+    string_depths_.vector().resize(size);
+    out_degrees_.vector().resize(size);
+    edge_begins_.vector().resize(size);
+    if constexpr (stores_leaf_ranges<Node>::value) {
+      leftmost_leaves_.vector().resize(size);
+      rightmost_leaves_.vector().resize(size);
+    }
+  }
+
+  /// \brief Prefetches the fields of the node at position \e pos.
+  inline void prefetch(const size_t pos) const {
+    __builtin_prefetch(string_depths_.data() + pos);
+    __builtin_prefetch(out_degrees_.data() + pos);
+    __builtin_prefetch(edge_begins_.data() + pos);
+  }
+
+  void save(dpt::util::index_writer& writer) const {
+    writer.write(string_depths_);
+    writer.write(out_degrees_);
+    writer.write(edge_begins_);
+    writer.write(leftmost_leaves_);
+    writer.write(rightmost_leaves_);
+  }
+
+  bool load(dpt::util::index_reader& reader) {
+    return reader.read(string_depths_) && reader.read(out_degrees_) &&
+      reader.read(edge_begins_) && reader.read(leftmost_leaves_) &&
+      reader.read(rightmost_leaves_);
+  }
+
+private:
+  dpt::util::mapped_vector<depth_type> string_depths_;
+  dpt::util::mapped_vector<degree_type> out_degrees_;
+  dpt::util::mapped_vector<index_type> edge_begins_;
+  // Only used if the nodes store their leaf intervals.
+  dpt::util::mapped_vector<index_type> leftmost_leaves_;
+  dpt::util::mapped_vector<index_type> rightmost_leaves_;
+
+}; // class split_nodes
+
+} // namespace tree
+} // namespace dpt
+
+#endif // DPT_TREE_NODE_STORAGE_HEADER
+
+/******************************************************************************/
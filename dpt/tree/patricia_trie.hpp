@@ -10,9 +10,12 @@
 
 #pragma once
 
+#include <limits>
+
 #include "com/manager.hpp"
 #include "query/query_list.hpp"
 #include "util/partition.hpp"
+#include "util/serialization.hpp"
 
 namespace dpt {
 namespace tree {
@@ -32,9 +35,10 @@ public:
 
   template <template <typename, typename, typename> class Communication>
   void construct(partition&& local_sa, partition&& local_lcp,
-    manager& manager, const GlobalIndex max_lcp) {
+    manager& manager, const GlobalIndex max_lcp, const size_t nr_threads = 1) {
     local_sa_ = std::move(local_sa);
-    trie_.template construct<Communication>(local_sa_, local_lcp, manager, max_lcp);
+    trie_.template construct<Communication>(local_sa_, local_lcp, manager,
+      max_lcp, nr_threads);
   }
 
   std::pair<std::array<GlobalIndex, 2>, std::array<GlobalIndex, 2>>
@@ -43,22 +47,39 @@ public:
   }
 
   template <template <typename, typename, typename> class Communication>
-  inline auto existential_batched(q_list&& rec_queries, manager& manager)
-    const {
+  inline auto existential_batched(q_list&& rec_queries, manager& manager,
+    const size_t nr_threads = 1) const {
     return trie_.template existential_batched<Communication>(
-      std::move(rec_queries), manager, local_sa_);
+      std::move(rec_queries), manager, local_sa_, nr_threads);
   }
 
   template <template <typename, typename, typename> class Communication>
-  inline auto counting_batched(q_list&& rec_queries, manager& manager) const {
+  inline auto counting_batched(q_list&& rec_queries, manager& manager,
+    const size_t nr_threads = 1) const {
     return trie_.template counting_batched<Communication>(
-      std::move(rec_queries), manager, local_sa_);
+      std::move(rec_queries), manager, local_sa_, nr_threads);
   }
 
   template <template <typename, typename, typename> class Communication>
-  inline auto enumeration_batched(q_list&& rec_queries, manager& manager) const {
+  inline auto enumeration_batched(q_list&& rec_queries, manager& manager,
+    const size_t nr_threads = 1,
+    const size_t limit = std::numeric_limits<size_t>::max()) const {
     return trie_.template enumeration_batched<Communication>(
-      std::move(rec_queries), manager, local_sa_);
+      std::move(rec_queries), manager, local_sa_, nr_threads, limit);
+  }
+
+  /// \returns The local slice of the suffix array.
+  inline const partition& local_sa() const {
+    return local_sa_;
+  }
+
+  void save(dpt::util::index_writer& writer) const {
+    local_sa_.save(writer);
+    trie_.save(writer);
+  }
+
+  bool load(dpt::util::index_reader& reader) {
+    return local_sa_.load(reader) && trie_.load(reader);
   }
 
 private:
@@ -12,33 +12,62 @@
 #ifndef DPT_TREE_PATRICIA_TRIE_POINTER_HEADER
 #define DPT_TREE_PATRICIA_TRIE_POINTER_HEADER
 
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
 #include "com/manager.hpp"
 #include "query/query_list.hpp"
+#include "tree/child_search.hpp"
+#include "tree/node_layout.hpp"
+#include "tree/node_storage.hpp"
 #include "tree/pointer_node.hpp"
 #include "tree/search_result.hpp"
+#include "util/mapped_vector.hpp"
+#include "util/parallel.hpp"
 #include "util/partition.hpp"
+#include "util/serialization.hpp"
 
 #include "mpi/environment.hpp"
 
 namespace dpt {
 namespace tree {
 
-template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
+/// \tparam LeafRanges If \e true, each node stores the leftmost and rightmost
+///         leaf of its subtrie (see \e ranged_trie_node), i.e., counting and
+///         enumeration queries do not descend to the leaves of a match.
+/// \tparam NodeStorage Layout of the nodes: \e packed_nodes (array of
+///         structures) or \e split_nodes (structure of arrays).
+template <typename Alphabet, typename GlobalIndex, typename LocalIndex,
+          bool LeafRanges = false,
+          template <typename> class NodeStorage = packed_nodes>
 class patricia_trie_pointer {
 
-  using node = trie_node<Alphabet, LocalIndex>;
+  using node = select_trie_node<Alphabet, LocalIndex, LeafRanges>;
   using q_list = dpt::query::query_list<Alphabet, GlobalIndex, LocalIndex>;
   using q_view = dpt::query::query_view<Alphabet, LocalIndex>;
 
 public:
   patricia_trie_pointer() { }
 
+  /// \param nr_threads Number of threads used to build the trie. If greater
+  ///        than one, the suffix array is split into chunks of subtries of the
+  ///        root that are built in parallel (see \e construct_parallel).
   template <template <typename, typename, typename> class Communication>
   void construct(
     const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_sa,
     const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_lcp,
     dpt::com::manager<Alphabet, GlobalIndex, LocalIndex>& manager,
-    const GlobalIndex max_lcp) {
+    const GlobalIndex max_lcp, const size_t nr_threads = 1) {
+
+    if (nr_threads > 1 && local_sa.local_size() > 1) {
+      construct_parallel<Communication>(local_sa, local_lcp, manager, max_lcp,
+        nr_threads);
+      return;
+    }
 
     auto sa_iterator = local_sa.data_begin();
     auto lcp_iterator = local_lcp.data_begin();
@@ -57,13 +86,6 @@ public:
     global_lcp_[0] = prev_lcp;
     global_lcp_[1] = cur_lcp;
 
-    struct stack_element {
-      GlobalIndex lcp;
-      Alphabet nr_children;
-      GlobalIndex node_buffer_pos;
-      GlobalIndex text_buffer_pos;
-    } __attribute__ ((packed));
-
     std::vector<node> node_buffer;
     std::vector<stack_element> node_stack;
     std::vector<GlobalIndex> text_pos_buffer;
@@ -80,6 +102,10 @@ public:
     while(!finished) {
       finished = update_check_iterators(prev_sa, cur_sa, prev_lcp, cur_lcp,
         sa_iterator, sa_end, lcp_iterator, lcp_end);
+      // There is no further entry (the current one has already been inserted)
+      if (finished) {
+        break;
+      }
       ++cur_sa_pos;
       // Entry is considered (its LCP value is not longer than the threshold)
       if (cur_lcp < max_lcp) {
@@ -139,151 +165,406 @@ public:
     std::vector<GlobalIndex>().swap(text_pos_buffer);
     std::vector<node>().swap(node_buffer);
     labels_ = manager.template request_characters<Communication>(requests);
+    if constexpr (LeafRanges) {
+      compute_leaf_ranges(nodes_, root_);
+    }
+    relayout();
   }
 
   auto global_sa_and_lcp() const {
     return std::make_pair(global_sa_, global_lcp_);
   }
 
+  /// \param nr_threads Number of threads used for the blind search and the
+  ///        verification of the queries.
   template <template <typename, typename, typename> class Communication>
   std::vector<search_state> existential_batched(q_list&& rec_queries,
     dpt::com::manager<Alphabet, GlobalIndex, LocalIndex>& manager,
-    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_sa)
-    const {
-
-    dpt::mpi::environment env;
+    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_sa,
+    const size_t nr_threads = 1) const {
+
+    // The position of a result is the local SA position of the leftmost leaf
+    // below the node found by the blind search.
+    std::vector<search_result<LocalIndex>> bs_results(rec_queries.size());
+    dpt::util::parallel_blocks(rec_queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        blind_search_batched(rec_queries, begin, end, bs_results);
+        for (size_t i = begin; i < end; ++i) {
+          if (bs_results[i].state == search_state::NOT_YET_FOUND) {
+            bs_results[i].position =
+              leftmost_leaf(node_at(bs_results[i].position));
+          }
+        }
+      });
 
     std::vector<GlobalIndex> req_positions;
     std::vector<LocalIndex> req_lengths;
-    std::vector<search_state> states;
-    for (const auto& query : rec_queries) {
-      auto bs_res = blind_search_first_sa_position(query);
-      states.emplace_back(bs_res.state);
-      if (bs_res.state == search_state::NOT_YET_FOUND) {
-        req_positions.emplace_back(local_sa[bs_res.position]);
-        req_lengths.emplace_back(query.length);
+    std::vector<size_t> substr_positions(rec_queries.size(), 0);
+    for (size_t i = 0, cur_substr_pos = 0; i < rec_queries.size(); ++i) {
+      if (bs_results[i].state == search_state::NOT_YET_FOUND) {
+        req_positions.emplace_back(local_sa[bs_results[i].position]);
+        req_lengths.emplace_back(rec_queries[i].length);
+        substr_positions[i] = cur_substr_pos;
+        cur_substr_pos += rec_queries[i].length;
       }
     }
 
     auto req_substrings =
       manager.template request_substrings<Communication>(
         req_positions, req_lengths);
-    for (size_t i = 0, cur_substr_pos = 0; i < rec_queries.size(); ++i) {
-      if (states[i] == search_state::NOT_YET_FOUND) {
-        size_t pos = 0;
-        while (pos < rec_queries[i].length && 
-            req_substrings[cur_substr_pos + pos] == rec_queries[i][pos]) {
-          ++pos;
+    std::vector<search_state> states(rec_queries.size());
+    dpt::util::parallel_blocks(rec_queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          states[i] = bs_results[i].state;
+          if (states[i] == search_state::NOT_YET_FOUND) {
+            states[i] = matches(rec_queries[i], req_substrings,
+              substr_positions[i], 0) ?
+              search_state::MATCH : search_state::NO_MATCH;
+          }
         }
-        cur_substr_pos += rec_queries[i].length;
-        states[i] = (pos == rec_queries[i].length) ?
-          search_state::MATCH : search_state::NO_MATCH;
-      }
-    }
+      });
     return states;
   }
 
+  /// \param nr_threads Number of threads used for the blind search and the
+  ///        verification of the queries.
   template <template <typename, typename, typename> class Communication>
   std::vector<LocalIndex> counting_batched(q_list&& rec_queries,
     dpt::com::manager<Alphabet, GlobalIndex, LocalIndex>& manager,
-    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_sa)
-    const {
+    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_sa,
+    const size_t nr_threads = 1) const {
+
+    std::vector<search_result<LocalIndex>> search_results(rec_queries.size());
+    dpt::util::parallel_blocks(rec_queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        blind_search_batched(rec_queries, begin, end, search_results);
+      });
 
     std::vector<GlobalIndex> req_positions;
     std::vector<LocalIndex> req_lengths;
-    std::vector<search_state> states;
-    std::vector<search_result<LocalIndex>> search_results;
-    for (const auto& query : rec_queries) {
-      search_results.emplace_back(blind_search_node_position(query));
-      if (search_results.back().state == search_state::NOT_YET_FOUND) {
-        req_positions.emplace_back(local_sa[leftmoste_leaf(nodes_[search_results.back().position]).edge_begin]);
-        req_lengths.emplace_back(query.length);
+    std::vector<size_t> substr_positions(rec_queries.size(), 0);
+    for (size_t i = 0, cur_substr_pos = 0; i < rec_queries.size(); ++i) {
+      if (search_results[i].state == search_state::NOT_YET_FOUND) {
+        req_positions.emplace_back(local_sa[
+          leftmost_leaf(node_at(search_results[i].position))]);
+        req_lengths.emplace_back(rec_queries[i].length);
+        substr_positions[i] = cur_substr_pos;
+        cur_substr_pos += rec_queries[i].length;
       }
     }
     auto req_substrings = manager.template request_substrings<Communication>(
       req_positions, req_lengths);
     std::vector<LocalIndex> nr_occurrences(rec_queries.size(), 0);
-    for (size_t i = 0, cur_substr_pos = 0; i < rec_queries.size(); ++i) {
-      if (search_results[i].state == search_state::NOT_YET_FOUND) {
-        size_t pos = 1;
-        while (pos < rec_queries[i].length && 
-          req_substrings[cur_substr_pos + pos] == rec_queries[i][pos]) {
-          ++pos;
+    dpt::util::parallel_blocks(rec_queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          if (search_results[i].state == search_state::NOT_YET_FOUND &&
+            matches(rec_queries[i], req_substrings, substr_positions[i], 1)) {
+            const node match = node_at(search_results[i].position);
+            nr_occurrences[i] = rightmost_leaf(match) -
+              leftmost_leaf(match) + 1;
+          }
         }
-        cur_substr_pos += rec_queries[i].length;
-        if (pos == rec_queries[i].length) {
-          nr_occurrences[i] =
-            rightmost_leaf(nodes_[search_results[i].position]).edge_begin -
-            leftmoste_leaf(nodes_[search_results[i].position]).edge_begin + 1;
-        }
-      }
-    }
+      });
     return nr_occurrences;
   }
 
+  /// \param nr_threads Number of threads used for the blind search, the
+  ///        verification of the queries and to copy the SA intervals.
+  /// \param limit Maximum number of occurrences reported per query. Only the
+  ///        first \e limit entries of each SA interval are copied.
   template <template <typename, typename, typename> class Communication>
   std::pair<std::vector<GlobalIndex>, std::vector<LocalIndex>>
     enumeration_batched(q_list&& rec_queries,
       dpt::com::manager<Alphabet, GlobalIndex, LocalIndex>& manager,
       const dpt::util::partition<GlobalIndex, GlobalIndex,
-      LocalIndex>& local_sa) const {
+      LocalIndex>& local_sa, const size_t nr_threads = 1,
+      const size_t limit = std::numeric_limits<size_t>::max()) const {
+
+    std::vector<search_result<LocalIndex>> search_results(rec_queries.size());
+    dpt::util::parallel_blocks(rec_queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        blind_search_batched(rec_queries, begin, end, search_results);
+      });
 
     std::vector<GlobalIndex> req_positions;
     std::vector<LocalIndex> req_lengths;
-    std::vector<search_state> states;
-    std::vector<search_result<LocalIndex>> search_results;
-    for (const auto& query : rec_queries) {
-      search_results.emplace_back(blind_search_node_position(query));
-      if (search_results.back().state == search_state::NOT_YET_FOUND) {
-        req_positions.emplace_back(
-          local_sa[leftmoste_leaf(nodes_[search_results.back().position]).edge_begin]);
-        req_lengths.emplace_back(query.length);
+    std::vector<size_t> substr_positions(rec_queries.size(), 0);
+    for (size_t i = 0, cur_substr_pos = 0; i < rec_queries.size(); ++i) {
+      if (search_results[i].state == search_state::NOT_YET_FOUND) {
+        req_positions.emplace_back(local_sa[
+          leftmost_leaf(node_at(search_results[i].position))]);
+        req_lengths.emplace_back(rec_queries[i].length);
+        substr_positions[i] = cur_substr_pos;
+        cur_substr_pos += rec_queries[i].length;
       }
     }
     auto req_substrings = manager.template request_substrings<Communication>(
       req_positions, req_lengths);
-    std::vector<GlobalIndex> intervals;
+    std::vector<LocalIndex> leftmost_positions(rec_queries.size(), 0);
     std::vector<LocalIndex> interval_sizes(rec_queries.size(), 0);
-    for (size_t i = 0, cur_substr_pos = 0; i < rec_queries.size(); ++i) {
-      if (search_results[i].state == search_state::NOT_YET_FOUND) {
-        size_t pos = 0;
-        while (pos < rec_queries[i].length && 
-            req_substrings[cur_substr_pos + pos] == rec_queries[i][pos]) {
-          ++pos;
+    dpt::util::parallel_blocks(rec_queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          if (search_results[i].state == search_state::NOT_YET_FOUND &&
+            matches(rec_queries[i], req_substrings, substr_positions[i], 0)) {
+            leftmost_positions[i] =
+              leftmost_leaf(node_at(search_results[i].position));
+            interval_sizes[i] = std::min<size_t>(limit,
+              rightmost_leaf(node_at(search_results[i].position)) -
+              leftmost_positions[i] + 1);
+          }
         }
-        cur_substr_pos += rec_queries[i].length;
-        if (pos == rec_queries[i].length) {
-          const auto leftmost =
-            leftmoste_leaf(nodes_[search_results[i].position]).edge_begin;
-          interval_sizes[i] =
-          rightmost_leaf(nodes_[search_results[i].position]).edge_begin -
-          leftmost + 1;
+      });
+
+    // Copy the intervals (in the order of the queries).
+    std::vector<size_t> interval_positions(rec_queries.size() + 1, 0);
+    for (size_t i = 0; i < rec_queries.size(); ++i) {
+      interval_positions[i + 1] = interval_positions[i] + interval_sizes[i];
+    }
+    std::vector<GlobalIndex> intervals(interval_positions.back());
+    dpt::util::parallel_blocks(rec_queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
           std::copy_n(local_sa.const_local_data()->begin() +
-            leftmoste_leaf(nodes_[search_results[i].position]).edge_begin,
-            interval_sizes[i], std::back_inserter(intervals));
+            leftmost_positions[i], interval_sizes[i],
+            intervals.begin() + interval_positions[i]);
         }
-      }
-    }
+      });
     return std::make_pair(intervals, interval_sizes);
   }
 
-  const node root() {
+  node root() const {
     return root_;
   }
 
-  const node get_node(const size_t pos) {
+  node get_node(const size_t pos) const {
     return nodes_[pos];
   }
 
-  const Alphabet get_label(const size_t pos) {
+  Alphabet get_label(const size_t pos) const {
     return labels_[pos];
   }
 
+  /// \brief Renumbers the nodes in blocked breadth-first order (see
+  ///        \e blocked_bfs_order) and moves their labels accordingly. This is
+  ///        done after the construction, where the nodes are in post-order.
+  ///
+  /// \param block_size Number of nodes per block (default: one page).
+  void relayout(const size_t block_size = default_block_size) {
+    const auto new_positions = blocked_bfs_order(nodes_, root_, block_size);
+    reorder_nodes(nodes_, root_, new_positions);
+    std::vector<Alphabet> labels(labels_.size());
+    for (size_t pos = 0; pos < new_positions.size(); ++pos) {
+      labels[new_positions[pos]] = labels_[pos];
+    }
+    labels_ = std::move(labels);
+    build_root_table();
+  }
+
   size_t number_of_nodes() const {
     return nodes_.size();
   }
 
+  void save(dpt::util::index_writer& writer) const {
+    writer.write(labels_);
+    nodes_.save(writer);
+    writer.write(root_);
+    writer.write(global_sa_);
+    writer.write(global_lcp_);
+  }
+
+  bool load(dpt::util::index_reader& reader) {
+    const bool success = reader.read(labels_) && nodes_.load(reader) &&
+      reader.read(root_) && reader.read(global_sa_) &&
+      reader.read(global_lcp_);
+    build_root_table();
+    return success;
+  }
+
 private:
+  /// \brief Builds the jump table for the children of the root (if the
+  ///        alphabet is small enough).
+  void build_root_table() {
+    root_table_.build(labels_.data() + root_.edge_begin,
+      root_.out_degree);
+  }
+
+  struct stack_element {
+    GlobalIndex lcp;
+    node_degree<Alphabet> nr_children;
+    GlobalIndex node_buffer_pos;
+    GlobalIndex text_buffer_pos;
+  } __attribute__ ((packed));
+
+  /// \brief Part of the trie built by one thread. \e nodes contains the
+  ///        (inner) nodes below the children of the root, \e top_nodes the
+  ///        children of the root. Inner nodes point into \e nodes.
+  struct subtrie_chunk {
+    std::vector<node> nodes;
+    std::vector<GlobalIndex> requests;
+    std::vector<node> top_nodes;
+    std::vector<GlobalIndex> top_requests;
+  }; // struct subtrie_chunk
+
+  /// \brief Builds the trie using multiple threads. The children of the root
+  ///        begin at the (considered) SA positions whose LCP-value is the
+  ///        string depth of the root. We split the SA at these positions into
+  ///        chunks of roughly the same size and build the subtries of each
+  ///        chunk independently. Afterwards, the chunks are concatenated (in
+  ///        the same order the sequential construction would have written the
+  ///        nodes), followed by the children of the root. Thus, the resulting
+  ///        nodes and labels are the same as for the sequential construction.
+  template <template <typename, typename, typename> class Communication>
+  void construct_parallel(
+    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_sa,
+    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_lcp,
+    dpt::com::manager<Alphabet, GlobalIndex, LocalIndex>& manager,
+    const GlobalIndex max_lcp, const size_t nr_threads) {
+
+    const LocalIndex size = local_sa.local_size();
+    // The sequential construction always considers the second entry.
+    const auto considered = [&](const LocalIndex pos) {
+      return pos == 1 || local_lcp[pos] < max_lcp;
+    };
+    GlobalIndex root_depth = local_lcp[1];
+    for (LocalIndex pos = 2; pos < size; ++pos) {
+      if (considered(pos)) {
+        root_depth = std::min(root_depth, local_lcp[pos]);
+      }
+    }
+    global_sa_[0] = local_sa[0];
+    global_sa_[1] = local_sa[size - 1];
+    global_lcp_[0] = local_lcp[0];
+    global_lcp_[1] = root_depth;
+
+    std::vector<LocalIndex> chunk_begins = { 0 };
+    for (size_t thread = 1; thread < nr_threads; ++thread) {
+      LocalIndex pos = std::max<LocalIndex>(chunk_begins.back() + 1,
+        (thread * size) / nr_threads);
+      while (pos < size &&
+        !(considered(pos) && local_lcp[pos] == root_depth)) {
+        ++pos;
+      }
+      if (pos >= size) {
+        break;
+      }
+      chunk_begins.emplace_back(pos);
+    }
+    chunk_begins.emplace_back(size);
+    const size_t nr_chunks = chunk_begins.size() - 1;
+
+    std::vector<subtrie_chunk> chunks(nr_chunks);
+    dpt::util::parallel_for(nr_chunks, nr_threads, [&](const size_t chunk) {
+      chunks[chunk] = construct_chunk(local_sa, local_lcp, chunk_begins[chunk],
+        chunk_begins[chunk + 1], root_depth, max_lcp);
+    });
+
+    // Compute where each chunk is written to and copy the chunks (adjusting
+    // the pointers of inner nodes) in parallel.
+    std::vector<LocalIndex> node_offsets(nr_chunks + 1, 0);
+    std::vector<LocalIndex> top_offsets(nr_chunks + 1, 0);
+    for (size_t chunk = 0; chunk < nr_chunks; ++chunk) {
+      node_offsets[chunk + 1] = node_offsets[chunk] +
+        chunks[chunk].nodes.size();
+      top_offsets[chunk + 1] = top_offsets[chunk] +
+        chunks[chunk].top_nodes.size();
+    }
+    const LocalIndex root_children_begin = node_offsets.back();
+    nodes_.resize(root_children_begin + top_offsets.back());
+    std::vector<GlobalIndex> requests(nodes_.size());
+    dpt::util::parallel_for(nr_chunks, nr_threads, [&](const size_t chunk) {
+      const auto copy_shifted = [&](const std::vector<node>& from,
+        const LocalIndex to) {
+        for (LocalIndex i = 0; i < from.size(); ++i) {
+          node cur_node = from[i];
+          if (cur_node.out_degree > 0) {
+            cur_node.edge_begin += node_offsets[chunk];
+          }
+          nodes_.set(to + i, cur_node);
+        }
+      };
+      copy_shifted(chunks[chunk].nodes, node_offsets[chunk]);
+      copy_shifted(chunks[chunk].top_nodes,
+        root_children_begin + top_offsets[chunk]);
+      std::copy(chunks[chunk].requests.begin(), chunks[chunk].requests.end(),
+        requests.begin() + node_offsets[chunk]);
+      std::copy(chunks[chunk].top_requests.begin(),
+        chunks[chunk].top_requests.end(),
+        requests.begin() + root_children_begin + top_offsets[chunk]);
+      std::vector<node>().swap(chunks[chunk].nodes);
+      std::vector<GlobalIndex>().swap(chunks[chunk].requests);
+    });
+    root_ = node(root_depth, top_offsets.back(), root_children_begin);
+    std::vector<subtrie_chunk>().swap(chunks);
+    labels_ = manager.template request_characters<Communication>(requests);
+    if constexpr (LeafRanges) {
+      compute_leaf_ranges(nodes_, root_);
+    }
+    relayout();
+  }
+
+  /// \brief Builds the subtries of the children of the root beginning in
+  ///        [\e begin, \e end). The root (of depth \e root_depth) is the
+  ///        bottom of the stack and is never removed.
+  subtrie_chunk construct_chunk(
+    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_sa,
+    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_lcp,
+    const LocalIndex begin, const LocalIndex end, const GlobalIndex root_depth,
+    const GlobalIndex max_lcp) const {
+
+    subtrie_chunk chunk;
+    std::vector<node> node_buffer;
+    std::vector<stack_element> node_stack;
+    std::vector<GlobalIndex> text_pos_buffer;
+
+    node_stack.emplace_back(stack_element { root_depth, 1, 0, 0 });
+    text_pos_buffer.emplace_back(local_sa[begin] + root_depth);
+
+    const auto pop_stack = [&]() {
+      const auto tmp = node_stack.back();
+      const LocalIndex old_req_size = chunk.requests.size();
+      std::copy_n(node_buffer.begin() + tmp.node_buffer_pos,
+        tmp.nr_children, std::back_inserter(chunk.nodes));
+      std::copy_n(text_pos_buffer.begin() + tmp.text_buffer_pos,
+        tmp.nr_children, std::back_inserter(chunk.requests));
+      node_buffer.resize(node_buffer.size() - tmp.nr_children);
+      node_buffer.emplace_back(tmp.lcp, tmp.nr_children, old_req_size);
+      text_pos_buffer.resize(text_pos_buffer.size() - tmp.nr_children);
+      node_stack.pop_back();
+    };
+
+    LocalIndex cur_leaf_pos = begin;
+    for (LocalIndex pos = begin + 1; pos < end; ++pos) {
+      const GlobalIndex cur_lcp = local_lcp[pos];
+      if (pos != 1 && cur_lcp >= max_lcp) {
+        continue;
+      }
+      node_buffer.emplace_back(node { 0, 0, cur_leaf_pos });
+      cur_leaf_pos = pos;
+      while (node_stack.back().lcp > cur_lcp) {
+        pop_stack();
+      }
+      if (node_stack.back().lcp == cur_lcp) {
+        ++(node_stack.back().nr_children);
+        text_pos_buffer.emplace_back(local_sa[pos] + cur_lcp);
+      } else {
+        node_stack.emplace_back(stack_element { cur_lcp, 2,
+          node_buffer.size() - 1, text_pos_buffer.size() });
+        text_pos_buffer.emplace_back(local_sa[pos - 1] + cur_lcp);
+        text_pos_buffer.emplace_back(local_sa[pos] + cur_lcp);
+      }
+    }
+    node_buffer.emplace_back(node { 0, 0, cur_leaf_pos });
+    while (node_stack.size() > 1) {
+      pop_stack();
+    }
+    chunk.top_nodes = std::move(node_buffer);
+    chunk.top_requests = std::move(text_pos_buffer);
+    return chunk;
+  }
+
   template <typename Iterator>
   inline bool update_check_iterators(GlobalIndex& prev_sa, GlobalIndex& cur_sa,
     GlobalIndex& prev_lcp, GlobalIndex& cur_lcp, Iterator& sa_iterator,
@@ -298,72 +579,148 @@ private:
     return true;
   }
 
-  search_result<LocalIndex> blind_search_first_sa_position(
-    const q_view& q) const {
-    node cur_node = root_;
-    while (cur_node.string_depth < q.length && cur_node.out_degree > 0) {
-      Alphabet child_nr = 0;
-      while (child_nr < cur_node.out_degree &&
-        labels_[cur_node.edge_begin + child_nr] < q[cur_node.string_depth]) {
-        ++child_nr;
-      }
-      if (child_nr == cur_node.out_degree ||
-        labels_[cur_node.edge_begin + child_nr] !=
-        q[cur_node.string_depth]) {
-        return { search_state::NO_MATCH, 0 };
-      } else {
-        cur_node = nodes_[cur_node.edge_begin + child_nr];
-      }
+  /// \returns \e true if the query matches the requested substring starting
+  ///          at \e substr_pos (comparing the characters from \e pos on).
+  inline bool matches(const q_view& query,
+    const std::vector<Alphabet>& substrings, const size_t substr_pos,
+    size_t pos) const {
+    while (pos < query.length && substrings[substr_pos + pos] == query[pos]) {
+      ++pos;
     }
-    return { search_state::NOT_YET_FOUND,
-      leftmoste_leaf(cur_node).edge_begin };
+    return pos == query.length;
   }
 
-  search_result<LocalIndex> blind_search_node_position(
-    const q_view& q) const {
-    node cur_node = root_;
-    LocalIndex node_pos = root_.edge_begin;
-    while (cur_node.string_depth < q.length && cur_node.out_degree > 0) {
-      Alphabet child_nr = 0;
-      while (child_nr < cur_node.out_degree &&
-        labels_[cur_node.edge_begin + child_nr] < q[cur_node.string_depth]) {
-        ++child_nr;
+  /// \brief Blind search of the queries [\e begin, \e end) in one traversal
+  ///        of the trie. All queries reaching a node are sorted by their
+  ///        character at the node's string depth, i.e., the queries sharing
+  ///        the same branching characters form a group that is passed on to
+  ///        the matching child. Hence, each node and its labels are accessed
+  ///        once per group instead of once per query. The result of each
+  ///        query is the same as for a blind search of the single query:
+  ///        the position of the node where it ends (queries not longer than
+  ///        its string depth or reaching a leaf), or \e NO_MATCH if a branching
+  ///        character is not a label of the node's children.
+  void blind_search_batched(const q_list& queries, const size_t begin,
+    const size_t end, std::vector<search_result<LocalIndex>>& results) const {
+    struct query_group {
+      LocalIndex node_pos;
+      size_t begin;
+      size_t end;
+    }; // struct query_group
+
+    std::vector<size_t> order(end - begin);
+    std::iota(order.begin(), order.end(), begin);
+    std::vector<query_group> groups = {
+      { LocalIndex(nodes_.size()), 0, order.size() } };
+    while (!groups.empty()) {
+      const query_group group = groups.back();
+      groups.pop_back();
+      const node cur_node = node_at(group.node_pos);
+      const auto depth = cur_node.string_depth;
+      const auto group_begin = order.begin() + group.begin;
+      const auto group_end = order.begin() + group.end;
+
+      // Queries not longer than the string depth of the node (or reaching a
+      // leaf) end at this node.
+      const auto searching = std::partition(group_begin, group_end,
+        [&](const size_t i) {
+          return queries[i].length <= depth || cur_node.out_degree == 0;
+        });
+      for (auto it = group_begin; it != searching; ++it) {
+        results[*it] = { search_state::NOT_YET_FOUND, group.node_pos };
       }
-      if (child_nr == cur_node.out_degree ||
-        labels_[cur_node.edge_begin + child_nr] !=
-        q[cur_node.string_depth]) {
-        return { search_state::NO_MATCH, 0 };
-      } else {
-        node_pos = cur_node.edge_begin + child_nr;
-        cur_node = nodes_[node_pos];
+      std::sort(searching, group_end, [&](const size_t lhs, const size_t rhs) {
+          return queries[lhs][depth] < queries[rhs][depth];
+        });
+
+      // Scan the children once for all characters of the group.
+      const size_t degree = cur_node.out_degree;
+      const bool use_root_table = child_jump_table<Alphabet>::available &&
+        group.node_pos == nodes_.size();
+      size_t child_nr = 0;
+      for (auto it = searching; it != group_end;) {
+        const Alphabet character = queries[*it][depth];
+        auto character_end = it;
+        while (character_end != group_end &&
+          queries[*character_end][depth] == character) {
+          ++character_end;
+        }
+        child_nr = use_root_table ? root_table_[character] :
+          child_nr + child_lower_bound(labels_.data() + cur_node.edge_begin +
+          child_nr, degree - child_nr, character);
+        if (child_nr < degree &&
+          labels_[cur_node.edge_begin + child_nr] == character) {
+          // The group is searched after the groups of all following children
+          // (which are pushed later), hence there is time to load the child.
+          nodes_.prefetch(cur_node.edge_begin + child_nr);
+          groups.push_back({ LocalIndex(cur_node.edge_begin + child_nr),
+            size_t(it - order.begin()), size_t(character_end - order.begin())
+          });
+        } else {
+          for (; it != character_end; ++it) {
+            results[*it] = { search_state::NO_MATCH, 0 };
+          }
+        }
+        it = character_end;
       }
     }
-    return { search_state::NOT_YET_FOUND, node_pos };
   }
 
-  inline node leftmoste_leaf(node cur_edge) const {
-    while (cur_edge.out_degree > 0) {
-      cur_edge = nodes_[cur_edge.edge_begin];
+  /// \returns The node at position \e pos or the root if \e pos is the
+  ///          number of nodes (the root is not stored in \e nodes_).
+  inline node node_at(const LocalIndex pos) const {
+    return (pos < nodes_.size()) ? nodes_[pos] : root_;
+  }
+
+  /// \returns The local SA position of the leftmost leaf below \e cur_edge.
+  inline LocalIndex leftmost_leaf(node cur_edge) const {
+    if constexpr (LeafRanges) {
+      return cur_edge.leftmost_leaf;
+    } else {
+      while (cur_edge.out_degree > 0) {
+        cur_edge = nodes_[cur_edge.edge_begin];
+      }
+      return cur_edge.edge_begin;
     }
-    return cur_edge;
   }
 
-  inline node rightmost_leaf(node cur_edge) const {
-    while (cur_edge.out_degree > 0) {
-      cur_edge = nodes_[cur_edge.edge_begin + cur_edge.out_degree - 1];
+  /// \returns The local SA position of the rightmost leaf below \e cur_edge.
+  inline LocalIndex rightmost_leaf(node cur_edge) const {
+    if constexpr (LeafRanges) {
+      return cur_edge.rightmost_leaf;
+    } else {
+      while (cur_edge.out_degree > 0) {
+        cur_edge = nodes_[cur_edge.edge_begin + cur_edge.out_degree - 1];
+      }
+      return cur_edge.edge_begin;
     }
-    return cur_edge;
   }
 
 private:
-  std::vector<Alphabet> labels_;
-  std::vector<node> nodes_;
+  /// Number of nodes that fit into one page.
+  static constexpr size_t default_block_size = 4096 / sizeof(node);
+
+  // Loaded labels are a view of the mapped index file (like the nodes).
+  dpt::util::mapped_vector<Alphabet> labels_;
+  NodeStorage<node> nodes_;
   node root_;
+  // Lower bounds of all characters among the children of the root.
+  child_jump_table<Alphabet> root_table_;
 
   std::array<GlobalIndex, 2> global_sa_;
   std::array<GlobalIndex, 2> global_lcp_;
 }; // class patricia_trie_pointer
 
+/// \brief \e patricia_trie_pointer whose nodes store their leaf intervals.
+template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
+using patricia_trie_pointer_leaf_ranges = patricia_trie_pointer<Alphabet,
+  GlobalIndex, LocalIndex, true>;
+
+/// \brief \e patricia_trie_pointer that stores its nodes as structure of arrays.
+template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
+using patricia_trie_pointer_split = patricia_trie_pointer<Alphabet, GlobalIndex,
+  LocalIndex, false, split_nodes>;
+
 } // namespace tree
 } // namespace dpt
 
@@ -0,0 +1,470 @@
+/*******************************************************************************
+ * dpt/tree/patricia_trie_succinct.hpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef DPT_TREE_PATRICIA_TRIE_SUCCINCT_HEADER
+#define DPT_TREE_PATRICIA_TRIE_SUCCINCT_HEADER
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <sdsl/int_vector.hpp>
+#include <sdsl/rank_support_v.hpp>
+#include <sdsl/select_support_mcl.hpp>
+#include <sdsl/util.hpp>
+#include <type_traits>
+#include <vector>
+
+#include "com/manager.hpp"
+#include "query/query_list.hpp"
+#include "tree/patricia_trie_pointer.hpp"
+#include "tree/search_result.hpp"
+#include "tree/succinct_node.hpp"
+#include "util/parallel.hpp"
+#include "util/partition.hpp"
+#include "util/serialization.hpp"
+
+namespace dpt {
+namespace tree {
+
+/// \brief Patricia trie (of the local slice of the suffix array) whose
+///        topology is stored as LOUDS bit vector.
+///
+/// The nodes are numbered in level order (the root has number 0). For each
+/// node, the LOUDS bit vector contains one 1 per child followed by a 0, i.e.,
+/// the children of a node are the nodes numbered rank_1(p) + 1, ... where
+/// \e p is the first bit of the node in the bit vector. The labels (first
+/// characters of the edges) are stored per node, the string depths per inner
+/// node, and the local SA positions per leaf, each in an \e sdsl::int_vector
+/// of minimal width. The trie is first built as \e patricia_trie_pointer and
+/// then converted, hence the queries have the same results.
+template <typename Alphabet, typename GlobalIndex, typename LocalIndex>
+class patricia_trie_succinct {
+
+  using node = succinct_node<LocalIndex>;
+  using pointer_trie = patricia_trie_pointer<Alphabet, GlobalIndex,
+    LocalIndex>;
+  using q_list = dpt::query::query_list<Alphabet, GlobalIndex, LocalIndex>;
+  using q_view = dpt::query::query_view<Alphabet, LocalIndex>;
+  using unsigned_alphabet = typename std::make_unsigned<Alphabet>::type;
+
+public:
+  patricia_trie_succinct() { }
+
+  // The rank and select support structures point to the bit vectors, hence
+  // they have to be pointed to the new bit vectors if the trie is copied or
+  // moved.
+  patricia_trie_succinct(const patricia_trie_succinct& other) {
+    *this = other;
+  }
+
+  patricia_trie_succinct(patricia_trie_succinct&& other) {
+    *this = std::move(other);
+  }
+
+  patricia_trie_succinct& operator = (const patricia_trie_succinct& other) {
+    louds_ = other.louds_;
+    inner_nodes_ = other.inner_nodes_;
+    labels_ = other.labels_;
+    string_depths_ = other.string_depths_;
+    sa_positions_ = other.sa_positions_;
+    global_sa_ = other.global_sa_;
+    global_lcp_ = other.global_lcp_;
+    louds_rank_ = other.louds_rank_;
+    louds_select_ = other.louds_select_;
+    inner_nodes_rank_ = other.inner_nodes_rank_;
+    set_support_vectors();
+    return *this;
+  }
+
+  patricia_trie_succinct& operator = (patricia_trie_succinct&& other) {
+    louds_ = std::move(other.louds_);
+    inner_nodes_ = std::move(other.inner_nodes_);
+    labels_ = std::move(other.labels_);
+    string_depths_ = std::move(other.string_depths_);
+    sa_positions_ = std::move(other.sa_positions_);
+    global_sa_ = other.global_sa_;
+    global_lcp_ = other.global_lcp_;
+    louds_rank_ = std::move(other.louds_rank_);
+    louds_select_ = std::move(other.louds_select_);
+    inner_nodes_rank_ = std::move(other.inner_nodes_rank_);
+    set_support_vectors();
+    return *this;
+  }
+
+  /// \param nr_threads Number of threads used to build the (pointer based)
+  ///        trie that is converted.
+  template <template <typename, typename, typename> class Communication>
+  void construct(
+    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_sa,
+    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_lcp,
+    dpt::com::manager<Alphabet, GlobalIndex, LocalIndex>& manager,
+    const GlobalIndex max_lcp, const size_t nr_threads = 1) {
+
+    pointer_trie trie;
+    trie.template construct<Communication>(local_sa, local_lcp, manager,
+      max_lcp, nr_threads);
+    std::tie(global_sa_, global_lcp_) = trie.global_sa_and_lcp();
+
+    // Traverse the trie in level order.
+    const size_t nr_nodes = trie.number_of_nodes() + 1;
+    louds_ = sdsl::bit_vector(2 * nr_nodes - 1, 0);
+    inner_nodes_ = sdsl::bit_vector(nr_nodes, 0);
+    labels_ = sdsl::int_vector<>(nr_nodes, 0, 8 * sizeof(Alphabet));
+    std::vector<decltype(trie.root())> level_order;
+    std::vector<uint64_t> string_depths;
+    std::vector<uint64_t> sa_positions;
+    level_order.reserve(nr_nodes);
+    level_order.emplace_back(trie.root());
+    for (size_t cur = 0, louds_pos = 0; cur < level_order.size(); ++cur) {
+      const auto cur_node = level_order[cur];
+      const size_t degree = cur_node.out_degree;
+      if (degree > 0) {
+        inner_nodes_[cur] = 1;
+        string_depths.emplace_back(cur_node.string_depth);
+        for (size_t child = 0; child < degree; ++child) {
+          louds_[louds_pos++] = 1;
+          labels_[level_order.size()] = unsigned_alphabet(
+            trie.get_label(cur_node.edge_begin + child));
+          level_order.emplace_back(trie.get_node(cur_node.edge_begin + child));
+        }
+      } else {
+        sa_positions.emplace_back(cur_node.edge_begin);
+      }
+      ++louds_pos;
+    }
+    string_depths_ = to_int_vector(string_depths);
+    sa_positions_ = to_int_vector(sa_positions);
+    sdsl::util::bit_compress(labels_);
+    init_support();
+  }
+
+  auto global_sa_and_lcp() const {
+    return std::make_pair(global_sa_, global_lcp_);
+  }
+
+  /// \param nr_threads Number of threads used for the blind search and the
+  ///        verification of the queries.
+  template <template <typename, typename, typename> class Communication>
+  std::vector<search_state> existential_batched(q_list&& rec_queries,
+    dpt::com::manager<Alphabet, GlobalIndex, LocalIndex>& manager,
+    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_sa,
+    const size_t nr_threads = 1) const {
+    std::vector<search_result<LocalIndex>> search_results;
+    std::vector<size_t> substr_positions;
+    const auto req_substrings = blind_search_and_request<Communication>(
+      rec_queries, manager, local_sa, nr_threads, search_results,
+      substr_positions);
+    std::vector<search_state> states(rec_queries.size());
+    dpt::util::parallel_blocks(rec_queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          states[i] = matches(rec_queries[i], search_results[i],
+            req_substrings, substr_positions[i]) ?
+            search_state::MATCH : search_state::NO_MATCH;
+        }
+      });
+    return states;
+  }
+
+  /// \param nr_threads Number of threads used for the blind search and the
+  ///        verification of the queries.
+  template <template <typename, typename, typename> class Communication>
+  std::vector<LocalIndex> counting_batched(q_list&& rec_queries,
+    dpt::com::manager<Alphabet, GlobalIndex, LocalIndex>& manager,
+    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_sa,
+    const size_t nr_threads = 1) const {
+    std::vector<search_result<LocalIndex>> search_results;
+    std::vector<size_t> substr_positions;
+    const auto req_substrings = blind_search_and_request<Communication>(
+      rec_queries, manager, local_sa, nr_threads, search_results,
+      substr_positions);
+    std::vector<LocalIndex> nr_occurrences(rec_queries.size(), 0);
+    dpt::util::parallel_blocks(rec_queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          if (matches(rec_queries[i], search_results[i], req_substrings,
+            substr_positions[i])) {
+            const node match = node_at(search_results[i].position);
+            nr_occurrences[i] = rightmost_leaf(match) - leftmost_leaf(match) +
+              1;
+          }
+        }
+      });
+    return nr_occurrences;
+  }
+
+  /// \param nr_threads Number of threads used for the blind search, the
+  ///        verification of the queries and to copy the SA intervals.
+  /// \param limit Maximum number of occurrences reported per query. Only the
+  ///        first \e limit entries of each SA interval are copied.
+  template <template <typename, typename, typename> class Communication>
+  std::pair<std::vector<GlobalIndex>, std::vector<LocalIndex>>
+    enumeration_batched(q_list&& rec_queries,
+      dpt::com::manager<Alphabet, GlobalIndex, LocalIndex>& manager,
+      const dpt::util::partition<GlobalIndex, GlobalIndex,
+      LocalIndex>& local_sa, const size_t nr_threads = 1,
+      const size_t limit = std::numeric_limits<size_t>::max()) const {
+    std::vector<search_result<LocalIndex>> search_results;
+    std::vector<size_t> substr_positions;
+    const auto req_substrings = blind_search_and_request<Communication>(
+      rec_queries, manager, local_sa, nr_threads, search_results,
+      substr_positions);
+    std::vector<LocalIndex> leftmost_positions(rec_queries.size(), 0);
+    std::vector<LocalIndex> interval_sizes(rec_queries.size(), 0);
+    dpt::util::parallel_blocks(rec_queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          if (matches(rec_queries[i], search_results[i], req_substrings,
+            substr_positions[i])) {
+            const node match = node_at(search_results[i].position);
+            leftmost_positions[i] = leftmost_leaf(match);
+            interval_sizes[i] = std::min<size_t>(limit,
+              rightmost_leaf(match) - leftmost_positions[i] + 1);
+          }
+        }
+      });
+
+    // Copy the intervals (in the order of the queries).
+    std::vector<size_t> interval_positions(rec_queries.size() + 1, 0);
+    for (size_t i = 0; i < rec_queries.size(); ++i) {
+      interval_positions[i + 1] = interval_positions[i] + interval_sizes[i];
+    }
+    std::vector<GlobalIndex> intervals(interval_positions.back());
+    dpt::util::parallel_blocks(rec_queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          std::copy_n(local_sa.data_begin() + leftmost_positions[i],
+            interval_sizes[i], intervals.begin() + interval_positions[i]);
+        }
+      });
+    return std::make_pair(intervals, interval_sizes);
+  }
+
+  size_t number_of_nodes() const {
+    return inner_nodes_.size();
+  }
+
+  void save(dpt::util::index_writer& writer) const {
+    save(writer, louds_);
+    save(writer, inner_nodes_);
+    save(writer, labels_);
+    save(writer, string_depths_);
+    save(writer, sa_positions_);
+    writer.write(global_sa_);
+    writer.write(global_lcp_);
+  }
+
+  bool load(dpt::util::index_reader& reader) {
+    const bool success = load(reader, louds_) && load(reader, inner_nodes_) &&
+      load(reader, labels_) && load(reader, string_depths_) &&
+      load(reader, sa_positions_) && reader.read(global_sa_) &&
+      reader.read(global_lcp_);
+    init_support();
+    return success;
+  }
+
+private:
+  /// \brief Builds the rank and select support structures.
+  void init_support() {
+    sdsl::util::init_support(louds_rank_, &louds_);
+    sdsl::util::init_support(louds_select_, &louds_);
+    sdsl::util::init_support(inner_nodes_rank_, &inner_nodes_);
+  }
+
+  /// \brief Points the (copied or moved) support structures to the bit
+  ///        vectors of this trie.
+  void set_support_vectors() {
+    louds_rank_.set_vector(&louds_);
+    louds_select_.set_vector(&louds_);
+    inner_nodes_rank_.set_vector(&inner_nodes_);
+  }
+
+  static sdsl::int_vector<> to_int_vector(const std::vector<uint64_t>& values) {
+    sdsl::int_vector<> result(values.size(), 0, 64);
+    for (size_t i = 0; i < values.size(); ++i) {
+      result[i] = values[i];
+    }
+    sdsl::util::bit_compress(result);
+    return result;
+  }
+
+  // An int_vector is stored as its width, its size, and its raw words.
+  template <uint8_t Width>
+  static void save(dpt::util::index_writer& writer,
+    const sdsl::int_vector<Width>& vector) {
+    writer.write(static_cast<uint8_t>(vector.width()));
+    writer.write(static_cast<uint64_t>(vector.size()));
+    writer.write(std::vector<uint64_t>(vector.data(),
+      vector.data() + (vector.bit_size() + 63) / 64));
+  }
+
+  template <uint8_t Width>
+  static bool load(dpt::util::index_reader& reader,
+    sdsl::int_vector<Width>& vector) {
+    uint8_t width = 0;
+    uint64_t size = 0;
+    std::vector<uint64_t> words;
+    if (!reader.read(width) || !reader.read(size) || !reader.read(words)) {
+      return false;
+    }
+    vector = sdsl::int_vector<Width>(size, 0, width);
+    if (words.size() != (vector.bit_size() + 63) / 64) {
+      return false;
+    }
+    std::copy(words.begin(), words.end(), vector.data());
+    return true;
+  }
+
+  /// \returns The node with number \e number.
+  inline node node_at(const size_t number) const {
+    return node(number, (number == 0) ? 0 : louds_select_(number) + 1);
+  }
+
+  inline bool is_leaf(const node& n) const {
+    return inner_nodes_[n.number] == 0;
+  }
+
+  inline size_t out_degree(const node& n) const {
+    return is_leaf(n) ? 0 : louds_select_(n.number + 1) - n.position;
+  }
+
+  inline node child(const node& n, const size_t child_nr) const {
+    return node_at(louds_rank_(n.position) + 1 + child_nr);
+  }
+
+  inline Alphabet label(const size_t number) const {
+    return Alphabet(unsigned_alphabet(labels_[number]));
+  }
+
+  inline size_t string_depth(const node& n) const {
+    return string_depths_[inner_nodes_rank_(n.number)];
+  }
+
+  /// \returns The local SA position of the leaf \e n.
+  inline LocalIndex sa_position(const node& n) const {
+    return sa_positions_[n.number - inner_nodes_rank_(n.number)];
+  }
+
+  /// \returns The local SA position of the leftmost leaf below \e n.
+  inline LocalIndex leftmost_leaf(node n) const {
+    while (!is_leaf(n)) {
+      n = child(n, 0);
+    }
+    return sa_position(n);
+  }
+
+  /// \returns The local SA position of the rightmost leaf below \e n.
+  inline LocalIndex rightmost_leaf(node n) const {
+    while (!is_leaf(n)) {
+      n = child(n, out_degree(n) - 1);
+    }
+    return sa_position(n);
+  }
+
+  /// \returns NOT_YET_FOUND and the number of the node found by the blind
+  ///          search or NO_MATCH if there is no matching child.
+  search_result<LocalIndex> blind_search(const q_view& q) const {
+    node cur_node = node_at(0);
+    while (!is_leaf(cur_node) && string_depth(cur_node) < q.length) {
+      const Alphabet character = q[string_depth(cur_node)];
+      const size_t first_child = louds_rank_(cur_node.position) + 1;
+      const size_t degree = out_degree(cur_node);
+      size_t child_nr = 0;
+      while (child_nr < degree && label(first_child + child_nr) < character) {
+        ++child_nr;
+      }
+      if (child_nr == degree || label(first_child + child_nr) != character) {
+        return { search_state::NO_MATCH, 0 };
+      }
+      cur_node = node_at(first_child + child_nr);
+    }
+    return { search_state::NOT_YET_FOUND, LocalIndex(cur_node.number) };
+  }
+
+  /// \brief Blind search of all queries (in parallel) followed by requesting
+  ///        the text at the leftmost occurrence of each found query.
+  ///
+  /// \returns The requested substrings. The substring of query \e i starts
+  ///          at \e substr_positions[i].
+  template <template <typename, typename, typename> class Communication>
+  std::vector<Alphabet> blind_search_and_request(const q_list& rec_queries,
+    dpt::com::manager<Alphabet, GlobalIndex, LocalIndex>& manager,
+    const dpt::util::partition<GlobalIndex, GlobalIndex, LocalIndex>& local_sa,
+    const size_t nr_threads,
+    std::vector<search_result<LocalIndex>>& search_results,
+    std::vector<size_t>& substr_positions) const {
+    search_results.resize(rec_queries.size());
+    std::vector<LocalIndex> leftmost_positions(rec_queries.size(), 0);
+    dpt::util::parallel_blocks(rec_queries.size(), nr_threads,
+      [&](const size_t, const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          search_results[i] = blind_search(rec_queries[i]);
+          if (search_results[i].state == search_state::NOT_YET_FOUND) {
+            leftmost_positions[i] = leftmost_leaf(
+              node_at(search_results[i].position));
+          }
+        }
+      });
+
+    std::vector<GlobalIndex> req_positions;
+    std::vector<LocalIndex> req_lengths;
+    substr_positions.assign(rec_queries.size(), 0);
+    for (size_t i = 0, cur_substr_pos = 0; i < rec_queries.size(); ++i) {
+      if (search_results[i].state == search_state::NOT_YET_FOUND) {
+        req_positions.emplace_back(local_sa[leftmost_positions[i]]);
+        req_lengths.emplace_back(rec_queries[i].length);
+        substr_positions[i] = cur_substr_pos;
+        cur_substr_pos += rec_queries[i].length;
+      }
+    }
+    return manager.template request_substrings<Communication>(req_positions,
+      req_lengths);
+  }
+
+  /// \returns \e true if the blind search found the query and the query
+  ///          matches the requested substring starting at \e substr_pos.
+  inline bool matches(const q_view& query,
+    const search_result<LocalIndex>& search_result,
+    const std::vector<Alphabet>& substrings, const size_t substr_pos) const {
+    if (search_result.state != search_state::NOT_YET_FOUND) {
+      return false;
+    }
+    size_t pos = 0;
+    while (pos < query.length && substrings[substr_pos + pos] == query[pos]) {
+      ++pos;
+    }
+    return pos == query.length;
+  }
+
+private:
+  // Topology: for each node (in level order) one 1 per child and a 0.
+  sdsl::bit_vector louds_;
+  sdsl::rank_support_v<1> louds_rank_;
+  sdsl::select_support_mcl<0> louds_select_;
+  // Marks the inner nodes (in level order).
+  sdsl::bit_vector inner_nodes_;
+  sdsl::rank_support_v<1> inner_nodes_rank_;
+  // Label of the edge to each node (in level order).
+  sdsl::int_vector<> labels_;
+  // String depth of each inner node and local SA position of each leaf.
+  sdsl::int_vector<> string_depths_;
+  sdsl::int_vector<> sa_positions_;
+
+  std::array<GlobalIndex, 2> global_sa_;
+  std::array<GlobalIndex, 2> global_lcp_;
+}; // class patricia_trie_succinct
+
+} // namespace tree
+} // namespace dpt
+
+#endif // DPT_TREE_PATRICIA_TRIE_SUCCINCT_HEADER
+
+/******************************************************************************/
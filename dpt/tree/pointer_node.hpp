@@ -10,20 +10,30 @@
 
 #pragma once
 
+#include <cstdint>
 #include <ostream>
+#include <type_traits>
 
 namespace dpt {
 namespace tree {
 
+/// \brief Unsigned type of the out-degree of a node. A node has at most one
+///        child per character, i.e., the type has to be wider than single
+///        byte alphabets (a node can have 256 children). Larger alphabets,
+///        e.g., word IDs, use 32 bits, independent of the size of a character.
+template <typename Alphabet>
+using node_degree = typename std::conditional<sizeof(Alphabet) == 1, uint16_t,
+  uint32_t>::type;
+
 template <typename Alphabet, typename LocalIndex>
 struct trie_node {
   LocalIndex string_depth;
-  Alphabet out_degree;
+  node_degree<Alphabet> out_degree;
   LocalIndex edge_begin;
 
   trie_node() = default;
 
-  trie_node(const LocalIndex string_dpth, const Alphabet out_dgr,
+  trie_node(const LocalIndex string_dpth, const node_degree<Alphabet> out_dgr,
             const LocalIndex edge_beg)
     : string_depth(string_dpth), out_degree(out_dgr), edge_begin(edge_beg) { }
 
@@ -34,6 +44,72 @@ struct trie_node {
   }
 } __attribute__ ((packed)); // struct trie_node
 
+/// \brief Node that additionally stores the positions of the leftmost and
+///        rightmost leaf of its subtrie (for a leaf, its own position). Thus,
+///        the leaf interval of a node is known without descending to it.
+template <typename Alphabet, typename LocalIndex>
+struct ranged_trie_node {
+  LocalIndex string_depth;
+  node_degree<Alphabet> out_degree;
+  LocalIndex edge_begin;
+  LocalIndex leftmost_leaf;
+  LocalIndex rightmost_leaf;
+
+  ranged_trie_node() = default;
+
+  ranged_trie_node(const LocalIndex string_dpth,
+                   const node_degree<Alphabet> out_dgr,
+                   const LocalIndex edge_beg)
+    : string_depth(string_dpth), out_degree(out_dgr), edge_begin(edge_beg),
+      leftmost_leaf(edge_beg), rightmost_leaf(edge_beg) { }
+
+  friend std::ostream& operator << (std::ostream& os,
+    const ranged_trie_node& te) {
+    return os << "(string_depth: " << static_cast<size_t>(te.string_depth)
+              << ", out_degree: " << static_cast<size_t>(te.out_degree)
+              << ", edge_begin: " << static_cast<size_t>(te.edge_begin)
+              << ", leaves: [" << static_cast<size_t>(te.leftmost_leaf)
+              << ", " << static_cast<size_t>(te.rightmost_leaf) << "])";
+  }
+} __attribute__ ((packed)); // struct ranged_trie_node
+
+/// \brief \e value is \e true if \e Node stores its leaf interval.
+template <typename Node>
+struct stores_leaf_ranges : std::false_type { };
+
+template <typename Alphabet, typename LocalIndex>
+struct stores_leaf_ranges<ranged_trie_node<Alphabet, LocalIndex>>
+  : std::true_type { };
+
+/// \brief Selects \e ranged_trie_node if \e LeafRanges is \e true and
+///        \e trie_node otherwise.
+template <typename Alphabet, typename LocalIndex, bool LeafRanges>
+using select_trie_node = typename std::conditional<LeafRanges,
+  ranged_trie_node<Alphabet, LocalIndex>,
+  trie_node<Alphabet, LocalIndex>>::type;
+
+/// \brief Computes the leaf intervals of all \e nodes and of \e root. The
+///        children of a node have to be stored before the node itself, which
+///        holds for the post-order in which the tries append their nodes.
+template <typename Nodes, typename Node>
+void compute_leaf_ranges(Nodes& nodes, Node& root) {
+  const auto set_range = [&](Node& n) {
+    if (n.out_degree != 0) {
+      n.leftmost_leaf = nodes[n.edge_begin].leftmost_leaf;
+      n.rightmost_leaf = nodes[n.edge_begin + n.out_degree - 1].rightmost_leaf;
+    } else {
+      n.leftmost_leaf = n.edge_begin;
+      n.rightmost_leaf = n.edge_begin;
+    }
+  };
+  for (size_t pos = 0; pos < nodes.size(); ++pos) {
+    Node n = nodes[pos];
+    set_range(n);
+    nodes.set(pos, n);
+  }
+  set_range(root);
+}
+
 } // namespace tree
 } // namespace dpt
 
@@ -11,6 +11,7 @@
 #pragma once
 
 #include <ostream>
+#include <tuple>
 
 namespace dpt {
 namespace tree {
@@ -26,7 +27,7 @@ struct succinct_node {
   : number(number), position(position) { }
 
   bool operator == (const succinct_node& n) const {
-    return std::tie(number, n.number) == std::tie(position, n.position);
+    return std::tie(number, position) == std::tie(n.number, n.position);
   }
 
   bool operator != (const succinct_node& n) const {
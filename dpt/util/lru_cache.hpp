@@ -0,0 +1,146 @@
+/*******************************************************************************
+ * dpt/util/lru_cache.hpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef DPT_UTIL_LRU_CACHE_HEADER
+#define DPT_UTIL_LRU_CACHE_HEADER
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace dpt {
+namespace util {
+
+/// \brief Bounded cache mapping byte strings to values. If the cache is full,
+///        the least recently used entry is evicted. A cache with capacity 0
+///        is disabled, i.e., it neither stores entries nor counts lookups.
+///
+/// \tparam Value Type of the cached values.
+template <typename Value>
+class lru_cache {
+
+public:
+  /// \param capacity Maximum number of cached entries.
+  lru_cache(const size_t capacity = 0) : capacity_(capacity), hits_(0),
+    misses_(0) { }
+
+  // The keys of the index point into the list, which remain valid when the
+  // list is moved but not when it is copied.
+  lru_cache(const lru_cache&) = delete;
+  lru_cache& operator = (const lru_cache&) = delete;
+  lru_cache(lru_cache&&) = default;
+  lru_cache& operator = (lru_cache&&) = default;
+
+  /// \brief Changes the capacity of the cache and evicts the least recently
+  ///        used entries that do not fit anymore.
+  void resize(const size_t capacity) {
+    capacity_ = capacity;
+    while (index_.size() > capacity_) {
+      evict();
+    }
+  }
+
+  /// \returns Pointer to the value cached for \e key (which is marked as the
+  ///          most recently used entry) or \e nullptr if \e key is not cached.
+  const Value* find(const std::string_view key) {
+    if (capacity_ == 0) {
+      return nullptr;
+    }
+    auto entry = index_.find(key);
+    if (entry == index_.end()) {
+      ++misses_;
+      return nullptr;
+    }
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, entry->second);
+    return &entry->second->second;
+  }
+
+  /// \brief Caches \e value for \e key (replacing the cached value if \e key
+  ///        is already cached).
+  void insert(const std::string_view key, const Value& value) {
+    if (capacity_ == 0) {
+      return;
+    }
+    auto entry = index_.find(key);
+    if (entry != index_.end()) {
+      entry->second->second = value;
+      entries_.splice(entries_.begin(), entries_, entry->second);
+      return;
+    }
+    if (index_.size() == capacity_) {
+      evict();
+    }
+    // The keys of the index point to the strings stored in the list, which
+    // are not moved when the list is changed.
+    entries_.emplace_front(std::string(key), value);
+    index_.emplace(entries_.front().first, entries_.begin());
+  }
+
+  /// \brief Removes all cached entries (the capacity and the statistics are
+  ///        not changed).
+  void clear() {
+    index_.clear();
+    entries_.clear();
+  }
+
+  /// \returns The maximum number of cached entries.
+  inline size_t capacity() const {
+    return capacity_;
+  }
+
+  /// \returns The number of cached entries.
+  inline size_t size() const {
+    return index_.size();
+  }
+
+  /// \returns The number of successful lookups.
+  inline uint64_t hits() const {
+    return hits_;
+  }
+
+  /// \returns The number of unsuccessful lookups.
+  inline uint64_t misses() const {
+    return misses_;
+  }
+
+  /// \brief Sets the number of hits and misses to 0.
+  void reset_statistics() {
+    hits_ = 0;
+    misses_ = 0;
+  }
+
+private:
+  using entry_list = std::list<std::pair<std::string, Value>>;
+
+  void evict() {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+
+  size_t capacity_;
+  uint64_t hits_;
+  uint64_t misses_;
+  // Entries in the order of their last use (most recently used first).
+  entry_list entries_;
+  std::unordered_map<std::string_view, typename entry_list::iterator> index_;
+
+}; // class lru_cache
+
+} // namespace util
+} // namespace dpt
+
+#endif // DPT_UTIL_LRU_CACHE_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,174 @@
+/*******************************************************************************
+ * dpt/util/mapped_vector.hpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef DPT_UTIL_MAPPED_VECTOR_HEADER
+#define DPT_UTIL_MAPPED_VECTOR_HEADER
+
+#include <cstdint>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace dpt {
+namespace util {
+
+/// \brief A file that is mapped into memory (privately, i.e., changes of the
+///        mapped memory are not written back). The pages are only read from
+///        disk when they are accessed for the first time.
+class mapped_file {
+
+public:
+  /// \param file_name Name of the file that is mapped.
+  mapped_file(const std::string& file_name) : data_(nullptr), size_(0) {
+    const int32_t fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+      void* data = mmap(nullptr, file_stat.st_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        data_ = static_cast<char*>(data);
+        size_ = file_stat.st_size;
+      }
+    }
+    close(fd);
+  }
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator = (const mapped_file&) = delete;
+
+  ~mapped_file() {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+    }
+  }
+
+  /// \returns \e true if the file has been mapped successfully.
+  inline bool good() const {
+    return data_ != nullptr;
+  }
+
+  inline char* data() const {
+    return data_;
+  }
+
+  inline size_t size() const {
+    return size_;
+  }
+
+private:
+  char* data_;
+  size_t size_;
+
+}; // class mapped_file
+
+/// \brief Array that either owns its elements (in a \e std::vector) or is a
+///        view of (a part of) a \e mapped_file, which is kept mapped as long
+///        as there is a view of it. Views are created when an index is
+///        loaded (see \e index_reader). Read access is the same for both
+///        cases, write access (see \e vector) copies the elements of a view
+///        into an owned vector first.
+///
+/// \tparam DataType Type of the elements.
+template <typename DataType>
+class mapped_vector {
+
+public:
+  using value_type = DataType;
+
+  mapped_vector() : mapped_data_(nullptr), mapped_size_(0) { }
+
+  mapped_vector(std::vector<DataType>&& data) : owned_(std::move(data)),
+    mapped_data_(nullptr), mapped_size_(0) { }
+
+  mapped_vector& operator = (std::vector<DataType>&& data) {
+    owned_ = std::move(data);
+    unmap();
+    return *this;
+  }
+
+  /// \brief Makes the array a view of \e size elements starting at \e data,
+  ///        which is mapped memory of \e file.
+  void map(std::shared_ptr<const mapped_file> file, DataType* data,
+    const size_t size) {
+    std::vector<DataType>().swap(owned_);
+    file_ = std::move(file);
+    mapped_data_ = data;
+    mapped_size_ = size;
+  }
+
+  /// \returns \e true if the array is a view of a mapped file.
+  inline bool is_mapped() const {
+    return file_ != nullptr;
+  }
+
+  inline size_t size() const {
+    return is_mapped() ? mapped_size_ : owned_.size();
+  }
+
+  inline bool empty() const {
+    return size() == 0;
+  }
+
+  inline const DataType* data() const {
+    return is_mapped() ? mapped_data_ : owned_.data();
+  }
+
+  inline const DataType& operator [] (const size_t pos) const {
+    return data()[pos];
+  }
+
+  inline const DataType* begin() const {
+    return data();
+  }
+
+  inline const DataType* end() const {
+    return data() + size();
+  }
+
+  /// \returns The owned elements, which can be changed. A view is copied
+  ///          into the owned vector first.
+  std::vector<DataType>& vector() {
+    if (is_mapped()) {
+      owned_.assign(mapped_data_, mapped_data_ + mapped_size_);
+      unmap();
+    }
+    return owned_;
+  }
+
+private:
+  inline void unmap() {
+    file_.reset();
+    mapped_data_ = nullptr;
+    mapped_size_ = 0;
+  }
+
+private:
+  std::vector<DataType> owned_;
+  std::shared_ptr<const mapped_file> file_;
+  DataType* mapped_data_;
+  size_t mapped_size_;
+
+}; // class mapped_vector
+
+} // namespace util
+} // namespace dpt
+
+#endif // DPT_UTIL_MAPPED_VECTOR_HEADER
+
+/******************************************************************************/
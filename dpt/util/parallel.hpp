@@ -0,0 +1,83 @@
+/*******************************************************************************
+ * dpt/util/parallel.hpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef DPT_UTIL_PARALLEL_HEADER
+#define DPT_UTIL_PARALLEL_HEADER
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace dpt {
+namespace util {
+
+/// \brief Executes \e function(task) for all tasks in [0, \e nr_tasks) using
+///        (up to) \e nr_threads threads. Task \e t is executed by thread
+///        \e t mod \e nr_threads, the calling thread executes the tasks of
+///        thread 0. Returns after all tasks have been executed.
+///
+/// \tparam Function Type of the function executed for each task.
+/// \param nr_tasks Number of tasks.
+/// \param nr_threads Maximum number of threads (including the calling one).
+/// \param function Function that is called with the number of the task.
+template <typename Function>
+inline void parallel_for(const size_t nr_tasks, const size_t nr_threads,
+  Function function) {
+  const size_t nr_workers = std::max<size_t>(
+    std::min(nr_tasks, nr_threads), 1);
+  const auto work = [&](const size_t worker) {
+    for (size_t task = worker; task < nr_tasks; task += nr_workers) {
+      function(task);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(nr_workers - 1);
+  for (size_t worker = 1; worker < nr_workers; ++worker) {
+    threads.emplace_back(work, worker);
+  }
+  work(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+/// \returns The number of blocks used by \e parallel_blocks for the requested
+///          number of blocks (at least one).
+inline size_t nr_parallel_blocks(const size_t nr_blocks) {
+  return std::max<size_t>(nr_blocks, 1);
+}
+
+/// \brief Splits [0, \e size) into \e nr_blocks consecutive blocks of (almost)
+///        the same size and executes \e function(block, begin, end) for each
+///        block on its own thread. If \e nr_blocks is zero, one block is
+///        used (see \e nr_parallel_blocks).
+///
+/// \tparam Function Type of the function executed for each block.
+/// \param size Number of elements that are split into blocks.
+/// \param requested_blocks Number of blocks (and threads).
+/// \param function Function that is called with the number of the block and
+///        the range [begin, end) of the block.
+template <typename Function>
+inline void parallel_blocks(const size_t size, const size_t requested_blocks,
+  Function function) {
+  const size_t nr_blocks = nr_parallel_blocks(requested_blocks);
+  parallel_for(nr_blocks, nr_blocks, [&](const size_t block) {
+    function(block, (block * size) / nr_blocks,
+      ((block + 1) * size) / nr_blocks);
+  });
+}
+
+} // namespace util
+} // namespace dpt
+
+#endif // DPT_UTIL_PARALLEL_HEADER
+
+/******************************************************************************/
@@ -17,7 +17,9 @@
 #include <vector>
 
 #include "mpi/environment.hpp"
+#include "util/mapped_vector.hpp"
 #include "util/named_structs.hpp"
+#include "util/serialization.hpp"
 
 namespace dpt {
 namespace util {
@@ -81,11 +83,13 @@ public:
     return local_size_;
   }
 
+  /// \returns The local data, which is copied first if it is a view of a
+  ///          loaded index (see \e const_local_data for read access).
   inline std::vector<Alphabet>* local_data() {
-    return &local_data_;
+    return &local_data_.vector();
   }
 
-  inline const std::vector<Alphabet>* const_local_data() const {
+  inline const mapped_vector<Alphabet>* const_local_data() const {
     return &local_data_;
   }
 
@@ -97,17 +101,48 @@ public:
     return local_data_.end();
   }
 
+  // If there are fewer elements than PEs, all elements are on the last PE.
   inline int32_t pe(const GlobalIndex index) const {
-    return std::min(
-      static_cast<int32_t>(index / local_size_), env_.size() -  1);
+    const size_t slice = slice_size();
+    return (slice == 0) ? env_.size() - 1 :
+      std::min(static_cast<int32_t>(index / slice), env_.size() -  1);
   }
 
   inline pe_and_position pe_and_norm_position(
     const GlobalIndex index) const {
-    const auto pe =
-      std::min(static_cast<int32_t>(index / local_size_), env_.size() - 1);
+    const size_t slice = slice_size();
+    const auto pe = (slice == 0) ? env_.size() - 1 :
+      std::min(static_cast<int32_t>(index / slice), env_.size() - 1);
     return pe_and_position { pe,
-      static_cast<LocalIndex>(index - (pe * local_size_)) };
+      static_cast<LocalIndex>(index - (pe * slice)) };
+  }
+
+  /// \param writer Writer the partition (without its environment) is saved to.
+  void save(index_writer& writer) const {
+    writer.write(global_size_);
+    writer.write(local_size_);
+    writer.write(local_data_);
+  }
+
+  /// \param reader Reader the partition is loaded from.
+  /// \returns \e true if the partition has been loaded successfully.
+  bool load(index_reader& reader) {
+    return reader.read(global_size_) && reader.read(local_size_) &&
+      reader.read(local_data_);
+  }
+
+private:
+  /// \returns The number of elements on each but the last processing element.
+  ///          When the data is distributed in blocks (see
+  ///          \e dpt::mpi::distribute_file), the last processing element also
+  ///          holds the remaining elements, i.e., its local size is larger.
+  inline size_t slice_size() const {
+    const size_t block_size = global_size_ / env_.size();
+    if (env_.rank() + 1 == env_.size() && local_size_ != block_size &&
+      local_size_ == global_size_ - block_size * (env_.size() - 1)) {
+      return block_size;
+    }
+    return local_size_;
   }
 
 private:
@@ -115,7 +150,7 @@ private:
 
   size_t global_size_;
   size_t local_size_;
-  std::vector<Alphabet> local_data_;
+  mapped_vector<Alphabet> local_data_;
 
 }; // class partition
 
@@ -0,0 +1,191 @@
+/*******************************************************************************
+ * dpt/util/serialization.hpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef DPT_UTIL_SERIALIZATION_HEADER
+#define DPT_UTIL_SERIALIZATION_HEADER
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "util/mapped_vector.hpp"
+
+namespace dpt {
+namespace util {
+
+/// Arrays are stored such that their elements start at a multiple of
+/// \e array_alignment bytes (relative to the beginning of the file), which
+/// allows to use them directly in a mapped file.
+constexpr size_t array_alignment = 8;
+
+/// \brief Writes trivially copyable values and arrays of such values to a
+///        binary file. Arrays are stored as their size followed by the raw
+///        elements (aligned, see \e array_alignment), such that they can be
+///        read with an \e index_reader.
+class index_writer {
+
+public:
+  /// \param file_name Name of the file that is (over-)written.
+  index_writer(const std::string& file_name)
+  : stream_(file_name.c_str(),
+      std::ios::out | std::ios::binary | std::ios::trunc), position_(0) { }
+
+  /// \returns \e true if all previous writes were successful.
+  inline bool good() const {
+    return stream_.good();
+  }
+
+  template <typename DataType>
+  inline void write(const DataType& value) {
+    static_assert(std::is_trivially_copyable<DataType>::value,
+      "Only trivially copyable types can be written.");
+    write_raw(reinterpret_cast<const char*>(&value), sizeof(DataType));
+  }
+
+  template <typename DataType>
+  inline void write(const std::vector<DataType>& data) {
+    write_array(data.data(), data.size());
+  }
+
+  template <typename DataType>
+  inline void write(const mapped_vector<DataType>& data) {
+    write_array(data.data(), data.size());
+  }
+
+private:
+  template <typename DataType>
+  inline void write_array(const DataType* data, const size_t size) {
+    static_assert(std::is_trivially_copyable<DataType>::value,
+      "Only arrays of trivially copyable types can be written.");
+    static_assert(alignof(DataType) <= array_alignment,
+      "The alignment of the elements is too large.");
+    write(static_cast<uint64_t>(size));
+    const char padding[array_alignment] = { 0 };
+    write_raw(padding, (array_alignment - position_ % array_alignment) %
+      array_alignment);
+    write_raw(reinterpret_cast<const char*>(data), size * sizeof(DataType));
+  }
+
+  inline void write_raw(const char* data, const size_t bytes) {
+    stream_.write(data, bytes);
+    position_ += bytes;
+  }
+
+private:
+  std::ofstream stream_;
+  size_t position_;
+
+}; // class index_writer
+
+/// \brief Reads values written by an \e index_writer. The file is mapped into
+///        memory and arrays stored in \e mapped_vectors become views of the
+///        mapped file, i.e., loading an index does not copy them and their
+///        pages are read from disk when they are accessed for the first time.
+///        Arrays stored in \e std::vectors are copied from the mapped file.
+class index_reader {
+
+public:
+  /// \param file_name Name of the file that is read.
+  index_reader(const std::string& file_name)
+  : file_(std::make_shared<mapped_file>(file_name)), position_(0),
+    good_(file_->good()) { }
+
+  /// \returns \e true if the file could be mapped and all previous reads
+  ///          were successful.
+  inline bool good() const {
+    return good_;
+  }
+
+  /// \returns \e true if the whole file has been read.
+  inline bool finished() const {
+    return good_ && position_ == file_->size();
+  }
+
+  template <typename DataType>
+  inline bool read(DataType& value) {
+    static_assert(std::is_trivially_copyable<DataType>::value,
+      "Only trivially copyable types can be read.");
+    if (!advance(sizeof(DataType))) {
+      return false;
+    }
+    std::memcpy(&value, file_->data() + position_ - sizeof(DataType),
+      sizeof(DataType));
+    return true;
+  }
+
+  template <typename DataType>
+  inline bool read(std::vector<DataType>& data) {
+    const DataType* elements = nullptr;
+    size_t size = 0;
+    if (!read_array(elements, size)) {
+      return false;
+    }
+    data.assign(elements, elements + size);
+    return true;
+  }
+
+  template <typename DataType>
+  inline bool read(mapped_vector<DataType>& data) {
+    DataType* elements = nullptr;
+    size_t size = 0;
+    if (!read_array(elements, size)) {
+      return false;
+    }
+    data.map(file_, elements, size);
+    return true;
+  }
+
+private:
+  template <typename DataType>
+  inline bool read_array(DataType*& elements, size_t& size) {
+    static_assert(std::is_trivially_copyable<DataType>::value,
+      "Only arrays of trivially copyable types can be read.");
+    uint64_t nr_elements = 0;
+    if (!read(nr_elements) || !advance((array_alignment - position_ %
+      array_alignment) % array_alignment)) {
+      return false;
+    }
+    const size_t begin = position_;
+    if (nr_elements > file_->size() / sizeof(DataType) + 1 ||
+      !advance(nr_elements * sizeof(DataType))) {
+      return (good_ = false);
+    }
+    elements = reinterpret_cast<DataType*>(file_->data() + begin);
+    size = nr_elements;
+    return true;
+  }
+
+  /// \brief Skips the next \e bytes bytes if they are part of the file.
+  inline bool advance(const size_t bytes) {
+    if (!good_ || bytes > file_->size() - position_) {
+      return (good_ = false);
+    }
+    position_ += bytes;
+    return true;
+  }
+
+private:
+  std::shared_ptr<mapped_file> file_;
+  size_t position_;
+  bool good_;
+
+}; // class index_reader
+
+} // namespace util
+} // namespace dpt
+
+#endif // DPT_UTIL_SERIALIZATION_HEADER
+
+/******************************************************************************/
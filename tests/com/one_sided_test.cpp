@@ -8,13 +8,20 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
+#include <algorithm>
 #include <gtest/gtest.h>
 #include <memory>
 #include <stdint.h>
 #include <vector>
 
+#include "com/collective.hpp"
+#include "com/manager.hpp"
 #include "com/one_sided.hpp"
 #include "mpi/environment.hpp"
+#include "query/query_list.hpp"
+#include "tree/compact_trie_pointer.hpp"
+#include "tree/distributed_patricia_trie.hpp"
+#include "tree/patricia_trie_pointer.hpp"
 #include "util/partition.hpp"
 
 using partition = dpt::util::partition<char, uint32_t, uint32_t>;
@@ -29,13 +36,18 @@ protected:
     part_ = partition(
       static_cast<uint32_t>(content.size() * env_.size()),
       static_cast<uint32_t>(content.size()), std::move(content));
+    window_ = std::make_unique<dpt::mpi::requestable_array<char, true>>(
+      part_.local_size(), part_.local_data()->data(), part_.global_size());
   }
 
-  virtual void TearDown() { }
+  virtual void TearDown() {
+    window_.reset();
+  }
 
 public:
   dpt::mpi::environment env_;
   partition part_;
+  std::unique_ptr<dpt::mpi::requestable_array<char, true>> window_;
 }; // class one_sided_test
 
 TEST_F(one_sided_test, RequestCharacter) {
@@ -44,7 +56,7 @@ TEST_F(one_sided_test, RequestCharacter) {
     request_positions.emplace_back(1);
   }
   auto result = dpt::com::one_sided_communication<char, uint32_t, uint32_t>::
-    request_characters(request_positions, part_);
+    request_characters(request_positions, *window_);
   for (const auto& rec_char : result) {
     ASSERT_EQ('b', rec_char);
   }
@@ -57,7 +69,7 @@ TEST_F(one_sided_test, RequestCharacter) {
     }
   }
   result = dpt::com::one_sided_communication<char, uint32_t, uint32_t>::
-    request_characters(request_positions, part_);
+    request_characters(request_positions, *window_);
   for (const auto& rec_char : result) {
     ASSERT_EQ('b', rec_char);
   }
@@ -68,7 +80,7 @@ TEST_F(one_sided_test, RequestCharacter) {
     request_positions.emplace_back(text_pos);
   }
   result = dpt::com::one_sided_communication<char, uint32_t, uint32_t>::
-    request_characters(request_positions, part_);
+    request_characters(request_positions, *window_);
 
   for (uint32_t i = 0; i < result.size(); ++i) {
     ASSERT_EQ(static_cast<char>('a' + (i % part_.local_size())), result[i]);
@@ -83,7 +95,7 @@ TEST_F(one_sided_test, RequestSubstring) {
     request_lengths.emplace_back(i + 1);
   }
   auto result = dpt::com::one_sided_communication<char, uint32_t, uint32_t>::
-    request_substrings(request_positions, request_lengths, part_);
+    request_substrings(request_positions, request_lengths, *window_);
   for (size_t i = 0, pos = 0; i < request_positions.size(); ++i) {
     for (size_t j = 0; j < request_lengths[i]; ++j) {
       ASSERT_EQ(static_cast<char>('b' + j), result[pos++]);
@@ -100,7 +112,7 @@ TEST_F(one_sided_test, RequestSubstring) {
     }
   }
   result = dpt::com::one_sided_communication<char, uint32_t, uint32_t>::
-    request_substrings(request_positions, request_lengths, part_);
+    request_substrings(request_positions, request_lengths, *window_);
   for (size_t i = 0, pos = 0; i < request_positions.size(); ++i) {
     for (size_t j = 0; j < request_lengths[i]; ++j) {
       ASSERT_EQ(static_cast<char>('b' + j), result[pos++]);
@@ -119,7 +131,7 @@ TEST_F(one_sided_test, RequestSubstrinHead) {
   std::vector<char> tails;
   std::tie(heads, tails) =
     dpt::com::one_sided_communication<char, uint32_t, uint32_t>::
-    request_substrings_head(request_positions, request_lengths, part_);
+    request_substrings_head(request_positions, request_lengths, *window_);
   for (size_t i = 0, head_pos = 0, tail_pos = 0;
     i < request_positions.size(); ++i) {
     ASSERT_EQ(static_cast<char>('b'), heads[head_pos++]);
@@ -141,7 +153,7 @@ TEST_F(one_sided_test, RequestSubstrinHead) {
 
   std::tie(heads, tails) =
     dpt::com::one_sided_communication<char, uint32_t, uint32_t>::
-    request_substrings_head(request_positions, request_lengths, part_);
+    request_substrings_head(request_positions, request_lengths, *window_);
   for (size_t i = 0, head_pos = 0, tail_pos = 0;
     i < request_positions.size(); ++i) {
     ASSERT_EQ(static_cast<char>('b'), heads[head_pos++]);
@@ -151,4 +163,145 @@ TEST_F(one_sided_test, RequestSubstrinHead) {
   }
 }
 
+TEST_F(one_sided_test, IndependentRequests) {
+  // Only every second PE requests substrings, all others do not take part.
+  if (env_.rank() % 2 == 0) {
+    std::vector<uint32_t> request_positions;
+    std::vector<uint32_t> request_lengths;
+    for (int32_t rank = 0; rank < env_.size(); ++rank) {
+      request_positions.emplace_back(1 + (rank * part_.local_size()));
+      request_lengths.emplace_back(rank + 1);
+    }
+    auto result = window_->request(request_positions, request_lengths);
+    for (size_t i = 0, pos = 0; i < request_positions.size(); ++i) {
+      for (size_t j = 0; j < request_lengths[i]; ++j) {
+        ASSERT_EQ(static_cast<char>('b' + j), result[pos++]);
+      }
+    }
+    result = window_->request(request_positions);
+    for (const auto& rec_char : result) {
+      ASSERT_EQ('b', rec_char);
+    }
+  }
+  env_.barrier();
+}
+
+TEST_F(one_sided_test, Fences) {
+  dpt::mpi::requestable_array<char> window(part_.local_size(),
+    part_.local_data()->data(), part_.global_size());
+  // All PEs take part in the requests, even if they request nothing.
+  std::vector<uint32_t> request_positions;
+  std::vector<uint32_t> request_lengths;
+  for (int32_t i = 0; i < env_.rank(); ++i) {
+    request_positions.emplace_back(3 + (i * part_.local_size()));
+    request_lengths.emplace_back(2);
+  }
+  auto result = window.request(request_positions, request_lengths);
+  ASSERT_EQ(request_positions.size() * 2, result.size());
+  for (size_t i = 0; i < result.size(); ++i) {
+    ASSERT_EQ(static_cast<char>('d' + (i % 2)), result[i]);
+  }
+}
+
+TEST_F(one_sided_test, UnorderedRequests) {
+  // Positions in descending order (with duplicates) in multiple rounds. The
+  // substrings do not cross the end of a partition (there is no padding).
+  std::vector<uint32_t> request_positions;
+  std::vector<uint32_t> request_lengths;
+  for (size_t i = 0; i < 200000; ++i) {
+    const uint32_t pos = part_.global_size() - 1 - (i % part_.global_size());
+    request_positions.emplace_back(pos);
+    request_lengths.emplace_back(
+      std::min<uint32_t>(1 + (i % 3), part_.local_size() - (pos % 26)));
+  }
+  auto result = window_->request(request_positions, request_lengths);
+  for (size_t i = 0, pos = 0; i < request_positions.size(); ++i) {
+    for (size_t j = 0; j < request_lengths[i]; ++j) {
+      ASSERT_EQ(static_cast<char>(
+        'a' + ((request_positions[i] % part_.local_size()) + j) % 26),
+        result[pos++]);
+    }
+  }
+}
+
+TEST_F(one_sided_test, ManagerWindow) {
+  dpt::com::manager<char, uint32_t, uint32_t> manager(std::move(part_));
+  manager.create_text_window();
+  std::vector<uint32_t> request_positions;
+  std::vector<uint32_t> request_lengths;
+  for (int32_t rank = 0; rank < env_.size(); ++rank) {
+    request_positions.emplace_back(2 + (rank * 26));
+    request_lengths.emplace_back(3);
+  }
+  // The window of the manager is reused by all requests.
+  for (size_t round = 0; round < 3; ++round) {
+    auto result = manager.template
+      request_characters<dpt::com::one_sided_communication>(
+        request_positions);
+    for (const auto& rec_char : result) {
+      ASSERT_EQ('c', rec_char);
+    }
+    auto substrings = manager.template
+      request_substrings<dpt::com::one_sided_communication>(
+        request_positions, request_lengths);
+    for (size_t i = 0; i < substrings.size(); ++i) {
+      ASSERT_EQ(static_cast<char>('c' + (i % 3)), substrings[i]);
+    }
+  }
+}
+
+TEST_F(one_sided_test, DistributeQueries) {
+  // Each PE sends (rank + 1) queries to the next two PEs only. A query is
+  // "<rank of the sender><index of the query>" repeated (index + 1) times.
+  std::vector<char> queries;
+  std::vector<uint32_t> query_lengths;
+  std::vector<size_t> hist(env_.size(), 0);
+  std::vector<size_t> hist_lengths(env_.size(), 0);
+  for (int32_t pe = 0; pe < env_.size(); ++pe) {
+    if (pe != (env_.rank() + 1) % env_.size() &&
+      pe != (env_.rank() + 2) % env_.size()) {
+      continue;
+    }
+    for (int32_t i = 0; i <= env_.rank(); ++i) {
+      for (int32_t j = 0; j <= i; ++j) {
+        queries.emplace_back('a' + env_.rank());
+        queries.emplace_back('a' + i);
+      }
+      query_lengths.emplace_back(2 * (i + 1));
+      ++hist[pe];
+      hist_lengths[pe] += query_lengths.back();
+    }
+  }
+  auto expected = dpt::com::collective_communication<char, uint32_t, uint32_t>
+    ::distribute_queries(queries, query_lengths, hist_lengths, hist);
+  auto result = dpt::com::one_sided_communication<char, uint32_t, uint32_t>
+    ::distribute_queries(queries, query_lengths, hist_lengths, hist);
+  ASSERT_EQ(expected.size(), result.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i].length, result[i].length);
+    ASSERT_TRUE(std::equal(expected[i].query,
+      expected[i].query + expected[i].length, result[i].query));
+  }
+}
+
+TEST_F(one_sided_test, QueriesAfterCollectiveConstruction) {
+  // The window is not created during the construction, but by the first
+  // one-sided query (on all PEs).
+  using dp_trie = dpt::tree::distributed_patricia_trie<char, size_t, size_t,
+    dpt::tree::compact_trie_pointer, dpt::tree::patricia_trie_pointer>;
+  using q_list = dpt::query::query_list<char, size_t, size_t>;
+  dp_trie trie("test_data/the_three_brothers.txt", 335);
+  trie.construct<dpt::com::collective_communication,
+    dpt::com::collective_communication>();
+  std::vector<char> queries_txt = { 't', 'h', 'e', 'b', 'r', 'o', 'x', 'y' };
+  std::vector<size_t> query_lengths = { 3, 3, 2 };
+  q_list queries(std::move(queries_txt), std::move(query_lengths));
+  auto q_one_sided = queries;
+  auto expected = trie.counting_batched<dpt::com::collective_communication>(
+    std::move(queries));
+  auto result = trie.counting_batched<dpt::com::one_sided_communication>(
+    std::move(q_one_sided));
+  ASSERT_EQ(expected, result);
+}
+
 /******************************************************************************/
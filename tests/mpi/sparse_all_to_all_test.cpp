@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * tests/mpi/sparse_all_to_all_test.cpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "mpi/all_to_all.hpp"
+#include "mpi/environment.hpp"
+#include "mpi/sparse_all_to_all.hpp"
+#include "util/uint_types.hpp"
+
+// Each PE sends (rank + target + 1) elements to each PE that is selected.
+template <typename DataType, typename Selection>
+void check_sparse_alltoallv(Selection is_target) {
+  dpt::mpi::environment env;
+  std::vector<DataType> send_data;
+  std::vector<size_t> send_counts(env.size(), 0);
+  for (int32_t target = 0; target < env.size(); ++target) {
+    if (is_target(env.rank(), target)) {
+      send_counts[target] = env.rank() + target + 1;
+      for (size_t i = 0; i < send_counts[target]; ++i) {
+        send_data.emplace_back(DataType(env.rank() * 1000 + target * 10 + i));
+      }
+    }
+  }
+  auto expected = dpt::mpi::alltoallv_counts(send_data, send_counts, env);
+  // Multiple consecutive exchanges must not interfere.
+  for (size_t round = 0; round < 3; ++round) {
+    auto result = dpt::mpi::sparse_alltoallv_counts(send_data, send_counts,
+      env);
+    ASSERT_EQ(expected.first, result.first);
+    ASSERT_EQ(expected.second, result.second);
+  }
+  ASSERT_EQ(expected.second,
+    dpt::mpi::adaptive_alltoallv(send_data, send_counts, env));
+}
+
+TEST(sparse_all_to_all_test, single_target) {
+  dpt::mpi::environment env;
+  check_sparse_alltoallv<uint32_t>(
+    [&env](const int32_t rank, const int32_t target) {
+      return target == (rank + 1) % env.size();
+    });
+}
+
+TEST(sparse_all_to_all_test, no_target) {
+  check_sparse_alltoallv<uint64_t>([](const int32_t rank, const int32_t) {
+    return rank < 0;
+  });
+}
+
+TEST(sparse_all_to_all_test, all_targets) {
+  check_sparse_alltoallv<dpt::uint40>([](const int32_t, const int32_t) {
+    return true;
+  });
+}
+
+TEST(sparse_all_to_all_test, use_sparse) {
+  dpt::mpi::environment env;
+  std::vector<size_t> send_counts(env.size(), 0);
+  ASSERT_TRUE(dpt::mpi::use_sparse_alltoall(send_counts, env));
+  send_counts[(env.rank() + 1) % env.size()] = 5;
+  ASSERT_EQ(env.size() >= 8, dpt::mpi::use_sparse_alltoall(send_counts, env));
+  std::fill(send_counts.begin(), send_counts.end(), 1);
+  ASSERT_FALSE(dpt::mpi::use_sparse_alltoall(send_counts, env));
+}
+
+/******************************************************************************/
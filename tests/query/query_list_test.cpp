@@ -113,4 +113,27 @@ TEST_F(query_list_test, other_constructor) {
   }
 }
 
+TEST_F(query_list_test, distinct) {
+  // Each query is contained three times, interleaved with the others.
+  std::vector<char> queries;
+  std::vector<size_t> lengths;
+  for (size_t round = 0; round < 3; ++round) {
+    for (const auto& query : queries_) {
+      std::copy_n(query.query, query.length, std::back_inserter(queries));
+      lengths.emplace_back(query.length);
+    }
+  }
+  q_list list(std::move(queries), std::move(lengths));
+  auto distinct = list.distinct();
+
+  ASSERT_EQ(queries_.size(), distinct.first.size());
+  ASSERT_EQ(list.size(), distinct.second.size());
+  for (size_t i = 0; i < list.size(); ++i) {
+    ASSERT_EQ(i % queries_.size(), distinct.second[i]);
+    auto query = distinct.first[distinct.second[i]];
+    ASSERT_EQ(list[i].length, query.length);
+    ASSERT_TRUE(list[i] == query.query);
+  }
+}
+
 /******************************************************************************/
@@ -0,0 +1,96 @@
+/*******************************************************************************
+ * tests/sa/phi_lcp_test.cpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "com/collective.hpp"
+#include "com/local.hpp"
+#include "com/manager.hpp"
+#include "mpi/environment.hpp"
+#include "mpi/io.hpp"
+#include "sa/phi_lcp.hpp"
+
+using manager = dpt::com::manager<char, size_t, size_t>;
+
+void check_phi_lcp(const size_t max_lcp) {
+  dpt::mpi::environment env;
+  manager text_manager(dpt::mpi::distribute_file<char, size_t, size_t>(
+    "test_data/the_three_brothers.txt", max_lcp));
+  auto local_sa = dpt::mpi::distribute_file<size_t, size_t, size_t>(
+    "test_data/the_three_brothers_size_t_sa", 0);
+  auto expected_lcp = dpt::mpi::distribute_file<size_t, size_t, size_t>(
+    "test_data/the_three_brothers_size_t_lcp", 0);
+
+  dpt::util::partition<size_t, size_t, size_t> local_lcp;
+  if (env.size() == 1) {
+    local_lcp = dpt::sa::phi_lcp<dpt::com::local_communication>(local_sa,
+      text_manager, max_lcp);
+  } else {
+    local_lcp = dpt::sa::phi_lcp<dpt::com::collective_communication>(local_sa,
+      text_manager, max_lcp);
+  }
+
+  ASSERT_EQ(expected_lcp.local_size(), local_lcp.local_size());
+  ASSERT_EQ(expected_lcp.local_size(), local_lcp.local_data()->size());
+  for (size_t i = 0; i < local_lcp.local_size(); ++i) {
+    ASSERT_EQ(std::min(expected_lcp[i], max_lcp), local_lcp[i]);
+  }
+}
+
+TEST(phi_lcp_test, the_three_brothers_complete) {
+  check_phi_lcp(7000);
+}
+
+TEST(phi_lcp_test, the_three_brothers_bounded) {
+  check_phi_lcp(30);
+}
+
+TEST(phi_lcp_test, fewer_characters_than_pes) {
+  // If the text is shorter than the number of PEs, all characters (and the
+  // suffix array) are on the last PE (see dpt::mpi::distribute_file).
+  dpt::mpi::environment env;
+  const std::string text_path = "test_data/phi_lcp_test_tiny";
+  const std::string sa_path = "test_data/phi_lcp_test_tiny_sa";
+  if (env.rank() == 0) {
+    std::ofstream text_stream(text_path, std::ios::binary);
+    text_stream << "bab";
+    const std::vector<size_t> sa = { 1, 2, 0 };
+    std::ofstream sa_stream(sa_path, std::ios::binary);
+    sa_stream.write(reinterpret_cast<const char*>(sa.data()),
+      sa.size() * sizeof(size_t));
+  }
+  env.barrier();
+  manager text_manager(dpt::mpi::distribute_file<char, size_t, size_t>(
+    text_path, 4));
+  auto local_sa = dpt::mpi::distribute_file<size_t, size_t, size_t>(
+    sa_path, 0);
+  env.barrier();
+  if (env.rank() == 0) {
+    std::remove(text_path.c_str());
+    std::remove(sa_path.c_str());
+  }
+
+  auto local_lcp = dpt::sa::phi_lcp<dpt::com::collective_communication>(
+    local_sa, text_manager, size_t(4));
+  ASSERT_EQ(local_sa.local_size(), local_lcp.local_size());
+  const std::vector<size_t> lcp = { 0, 0, 1 };
+  const size_t local_begin = (env.rank() + 1 == env.size()) ?
+    3 - local_lcp.local_size() : (3 / env.size()) * env.rank();
+  for (size_t i = 0; i < local_lcp.local_size(); ++i) {
+    ASSERT_EQ(lcp[local_begin + i], local_lcp[i]);
+  }
+}
+
+/******************************************************************************/
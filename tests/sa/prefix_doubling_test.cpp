@@ -0,0 +1,92 @@
+/*******************************************************************************
+ * tests/sa/prefix_doubling_test.cpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "mpi/environment.hpp"
+#include "mpi/io.hpp"
+#include "sa/prefix_doubling.hpp"
+
+TEST(prefix_doubling_test, the_three_brothers) {
+  auto local_text = dpt::mpi::distribute_file<char, size_t, size_t>(
+    "test_data/the_three_brothers.txt", 10);
+  auto expected_sa = dpt::mpi::distribute_file<size_t, size_t, size_t>(
+    "test_data/the_three_brothers_size_t_sa", 0);
+
+  auto local_sa = dpt::sa::prefix_doubling(local_text);
+
+  ASSERT_EQ(expected_sa.global_size(), local_sa.global_size());
+  ASSERT_EQ(expected_sa.local_size(), local_sa.local_size());
+  ASSERT_EQ(expected_sa.local_size(), local_sa.local_data()->size());
+  for (size_t i = 0; i < local_sa.local_size(); ++i) {
+    ASSERT_EQ(expected_sa[i], local_sa[i]);
+  }
+}
+
+TEST(prefix_doubling_test, periodic_text) {
+  dpt::mpi::environment env;
+  const size_t local_size = 37;
+  const size_t global_size = local_size * env.size();
+  std::vector<uint8_t> text(local_size);
+  for (size_t i = 0; i < local_size; ++i) {
+    text[i] = ((local_size * env.rank() + i) % 3 == 2) ? 'b' : 'a';
+  }
+  dpt::util::partition<uint8_t, uint32_t, uint32_t> local_text(global_size,
+    local_size, std::move(text), env);
+
+  auto local_sa = dpt::sa::prefix_doubling(local_text);
+  std::vector<uint32_t> sa(global_size);
+  MPI_Allgather(local_sa.local_data()->data(), local_size, MPI_UNSIGNED,
+    sa.data(), local_size, MPI_UNSIGNED, env.communicator());
+
+  std::vector<uint8_t> global_text(global_size);
+  for (size_t i = 0; i < global_size; ++i) {
+    global_text[i] = (i % 3 == 2) ? 'b' : 'a';
+  }
+  for (size_t i = 1; i < global_size; ++i) {
+    ASSERT_TRUE(std::lexicographical_compare(
+      global_text.begin() + sa[i - 1], global_text.end(),
+      global_text.begin() + sa[i], global_text.end()));
+  }
+}
+
+TEST(prefix_doubling_test, fewer_characters_than_pes) {
+  // If the text is shorter than the number of PEs, all characters are on the
+  // last PE (see dpt::mpi::distribute_file).
+  dpt::mpi::environment env;
+  const std::string text_path = "test_data/prefix_doubling_test_tiny";
+  if (env.rank() == 0) {
+    std::ofstream stream(text_path, std::ios::binary);
+    stream << "bab";
+  }
+  env.barrier();
+  auto local_text = dpt::mpi::distribute_file<char, size_t, size_t>(
+    text_path, 0);
+  env.barrier();
+  if (env.rank() == 0) {
+    std::remove(text_path.c_str());
+  }
+
+  auto local_sa = dpt::sa::prefix_doubling(local_text);
+  ASSERT_EQ(size_t(3), local_sa.global_size());
+  ASSERT_EQ(local_text.local_size(), local_sa.local_size());
+  const std::vector<size_t> sa = { 1, 2, 0 };
+  const size_t local_begin = (env.rank() + 1 == env.size()) ?
+    3 - local_sa.local_size() : (3 / env.size()) * env.rank();
+  for (size_t i = 0; i < local_sa.local_size(); ++i) {
+    ASSERT_EQ(sa[local_begin + i], local_sa[i]);
+  }
+}
+
+/******************************************************************************/
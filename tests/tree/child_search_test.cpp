@@ -0,0 +1,60 @@
+/*******************************************************************************
+ * tests/tree/child_search_test.cpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "tree/child_search.hpp"
+
+template <typename Alphabet>
+void check_child_lower_bound() {
+  // All characters (every second one) in sorted order, i.e., the labels of a
+  // node with the highest possible degree.
+  std::vector<Alphabet> all_labels;
+  for (int32_t c = 0; c < 256; c += 2) {
+    all_labels.emplace_back(static_cast<Alphabet>(c));
+  }
+  std::sort(all_labels.begin(), all_labels.end());
+  for (size_t nr_children = 0; nr_children <= all_labels.size();
+    ++nr_children) {
+    for (int32_t c = 0; c < 256; ++c) {
+      const Alphabet character = static_cast<Alphabet>(c);
+      const size_t expected = std::lower_bound(all_labels.begin(),
+        all_labels.begin() + nr_children, character) - all_labels.begin();
+      ASSERT_EQ(expected, dpt::tree::child_lower_bound(all_labels.data(),
+        nr_children, character));
+    }
+    if constexpr (dpt::tree::child_jump_table<Alphabet>::available) {
+      dpt::tree::child_jump_table<Alphabet> table;
+      table.build(all_labels.data(), nr_children);
+      for (int32_t c = 0; c < 256; ++c) {
+        const Alphabet character = static_cast<Alphabet>(c);
+        ASSERT_EQ(dpt::tree::child_lower_bound(all_labels.data(), nr_children,
+          character), table[character]);
+      }
+    }
+  }
+}
+
+TEST(child_search, signed_alphabet) {
+  check_child_lower_bound<char>();
+}
+
+TEST(child_search, unsigned_alphabet) {
+  check_child_lower_bound<uint8_t>();
+}
+
+TEST(child_search, wide_alphabet) {
+  check_child_lower_bound<uint16_t>();
+}
+
+/******************************************************************************/
@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include <fstream>
+#include <limits>
 #include <gtest/gtest.h>
 #include <memory>
 #include <stdlib.h>
@@ -82,6 +83,41 @@ public:
     return q_list(std::move(queries), std::move(query_lengths));
   }
 
+  // Builds a trie of type Trie and checks that it answers all types of
+  // queries (existing and non-existing) like pt_.
+  template <typename Trie>
+  void check_same_results() {
+    Trie other_pt;
+    if (env_.size() == 1) {
+      other_pt.template construct<dpt::com::local_communication>(
+        *(part_sa_.local_data()), *(part_lcp_.local_data()), manager_, 300);
+    } else {
+      other_pt.template construct<dpt::com::collective_communication>(
+        *(part_sa_.local_data()), *(part_lcp_.local_data()), manager_, 300);
+    }
+    q_list queries = gen_random_existing_queries(2000, 10);
+    std::vector<char> queries_txt = { 'x', 'p', 'l', 'a', 'r', 'e', 'h', 'e',
+      'r', 'e', ' ', 'a', 'x', 'a', 'r', 'g', 'x', 'a', 'r', 'g', 'f', 'l',
+      'o', 'w', 'e', 'r', 's', ','};
+    std::vector<size_t> query_lengths = { 6, 6, 4, 4, 8 };
+    q_list non_existing(std::move(queries_txt), std::move(query_lengths));
+    for (const auto& cur_queries : { queries, non_existing }) {
+      for (const auto& query : cur_queries) {
+        const auto result = pt_.first_occurrence(query);
+        const auto other_result = other_pt.first_occurrence(query);
+        ASSERT_EQ(result.state, other_result.state);
+        ASSERT_EQ(result.position, other_result.position);
+        const auto pair_result = pt_.first_and_last_occurrence(query);
+        const auto other_pair_result =
+          other_pt.first_and_last_occurrence(query);
+        ASSERT_EQ(pair_result.state, other_pair_result.state);
+        ASSERT_EQ(pair_result.left_position, other_pair_result.left_position);
+        ASSERT_EQ(pair_result.right_position,
+          other_pair_result.right_position);
+      }
+    }
+  }
+
 public:
   dpt::mpi::environment env_;
   compact_trie pt_;
@@ -163,4 +199,54 @@ TEST_F(compact_trie_pointer_test,
   }
 }
 
+TEST_F(compact_trie_pointer_test, interleaved_search) {
+  q_list queries = gen_random_existing_queries(2000, 10);
+  std::vector<dpt::tree::search_result<uint32_t>> results(queries.size());
+  std::vector<dpt::tree::search_result_pair<uint32_t>> pair_results(
+    queries.size());
+  // Search the queries in two (differently sized) parts.
+  pt_.first_occurrence_batched(queries, 0, 5, results);
+  pt_.first_occurrence_batched(queries, 5, queries.size(), results);
+  pt_.first_and_last_occurrence_batched(queries, 0, queries.size(),
+    pair_results);
+  for (size_t i = 0; i < queries.size(); ++i) {
+    const auto result = pt_.first_occurrence(queries[i]);
+    ASSERT_EQ(result.state, results[i].state);
+    ASSERT_EQ(result.position, results[i].position);
+    const auto pair_result = pt_.first_and_last_occurrence(queries[i]);
+    ASSERT_EQ(pair_result.state, pair_results[i].state);
+    ASSERT_EQ(pair_result.left_position, pair_results[i].left_position);
+    ASSERT_EQ(pair_result.right_position, pair_results[i].right_position);
+  }
+}
+
+TEST_F(compact_trie_pointer_test, leaf_ranges) {
+  check_same_results<dpt::tree::compact_trie_pointer_leaf_ranges<char, size_t,
+    size_t>>();
+}
+
+TEST_F(compact_trie_pointer_test, split_nodes) {
+  check_same_results<dpt::tree::compact_trie_pointer_split<char, size_t,
+    size_t>>();
+  check_same_results<dpt::tree::compact_trie_pointer<char, size_t, size_t,
+    true, dpt::tree::split_nodes>>();
+}
+
+TEST_F(compact_trie_pointer_test, relayout) {
+  q_list queries = gen_random_existing_queries(2000, 10);
+  for (const size_t block_size : { size_t(1), size_t(7),
+    std::numeric_limits<size_t>::max() }) {
+    compact_trie relayouted_pt = pt_;
+    relayouted_pt.relayout(block_size);
+    for (const auto& query : queries) {
+      const auto result = pt_.first_and_last_occurrence(query);
+      const auto relayouted_result =
+        relayouted_pt.first_and_last_occurrence(query);
+      ASSERT_EQ(result.state, relayouted_result.state);
+      ASSERT_EQ(result.left_position, relayouted_result.left_position);
+      ASSERT_EQ(result.right_position, relayouted_result.right_position);
+    }
+  }
+}
+
 /******************************************************************************/
@@ -8,9 +8,12 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
+#include <algorithm>
 #include <fstream>
 #include <gtest/gtest.h>
+#include <map>
 #include <memory>
+#include <sstream>
 #include <stdlib.h>
 #include <ctime>
 #include <vector>
@@ -68,6 +71,28 @@ public:
     return q_list(std::move(queries), std::move(query_lengths));
   }
 
+  size_t occurrences(const dpt::query::query_view<char, size_t>& query) {
+    size_t nr_occurrences = 0;
+    size_t cur_text_pos = 0;
+    while ((cur_text_pos = global_text_.find(query.query, cur_text_pos,
+      query.length)) != std::string::npos) {
+      ++nr_occurrences;
+      ++cur_text_pos;
+    }
+    return nr_occurrences;
+  }
+
+  std::vector<size_t> occurrence_positions(
+    const dpt::query::query_view<char, size_t>& query) {
+    std::vector<size_t> positions;
+    size_t cur_text_pos = 0;
+    while ((cur_text_pos = global_text_.find(query.query, cur_text_pos,
+      query.length)) != std::string::npos) {
+      positions.emplace_back(cur_text_pos++);
+    }
+    return positions;
+  }
+
 public:
   dp_trie dpt_;
   std::string global_text_;
@@ -95,22 +120,347 @@ TEST_F(dpt_test, first_occurrence_batched_non_existing) {
   }
 }
 
-// TEST_F(dpt_test, counting_batched_existing) {
-//   q_list queries = gen_random_existing_queries(2000, 10);
-//   auto results = dpt_.counting_batched<dpt::com::collective_communication>(
-//     std::move(queries));
-//   for (const auto result : results) {
-//     ASSERT_GE(result, static_cast<size_t>(0));
-//   }
-// }
-
-// TEST_F(dpt_test, enumeration_batched_existing) {
-//   q_list queries = gen_random_existing_queries(2000, 10);
-//   auto results = dpt_.enumeration_batched<dpt::com::collective_communication>(
-//     std::move(queries));
-//   for (const auto result : results.second) {
-//     ASSERT_GE(result, static_cast<size_t>(0));
-//   }
-// }
+TEST_F(dpt_test, existential_batched_original_order) {
+  std::vector<char> queries_txt;
+  std::vector<size_t> query_lengths;
+  std::vector<bool> expected;
+  const std::string non_existing[] = { "xplare", "here a", "xarg", "flowers," };
+  for (size_t i = 0; i < 200; ++i) {
+    std::string query = (i % 3 == 0) ? non_existing[(i / 3) % 4] :
+      global_text_.substr((i * 97) % (global_text_.size() - 20), 1 + i % 10);
+    std::copy(query.begin(), query.end(), std::back_inserter(queries_txt));
+    query_lengths.emplace_back(query.size());
+    expected.emplace_back(global_text_.find(query) != std::string::npos);
+  }
+  q_list queries(std::move(queries_txt), std::move(query_lengths));
+  auto results = dpt_.existential_batched<dpt::com::collective_communication>(
+    std::move(queries));
+  ASSERT_EQ(expected.size(), results.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    ASSERT_EQ(expected[i], results[i] == dpt::tree::search_state::MATCH);
+  }
+}
+
+TEST_F(dpt_test, existential_batched_computed_sa) {
+  dp_trie dpt_computed_sa("test_data/the_three_brothers.txt", "",
+    "test_data/the_three_brothers_size_t_lcp", 335);
+  dpt_computed_sa.construct<dpt::com::collective_communication,
+    dpt::com::collective_communication>();
+  q_list queries = gen_random_existing_queries(2000, 10);
+  auto results =
+    dpt_computed_sa.existential_batched<dpt::com::collective_communication>(
+    std::move(queries));
+  for (const auto& result : results) {
+    ASSERT_EQ(dpt::tree::search_state::MATCH, result);
+  }
+}
+
+TEST_F(dpt_test, existential_batched_text_only) {
+  dp_trie dpt_text_only("test_data/the_three_brothers.txt", 335);
+  dpt_text_only.construct<dpt::com::collective_communication,
+    dpt::com::collective_communication>();
+  q_list queries = gen_random_existing_queries(2000, 10);
+  auto results =
+    dpt_text_only.existential_batched<dpt::com::collective_communication>(
+    std::move(queries));
+  for (const auto& result : results) {
+    ASSERT_EQ(dpt::tree::search_state::MATCH, result);
+  }
+}
+
+TEST_F(dpt_test, existential_batched_with_threads) {
+  q_list queries = gen_random_existing_queries(2000, 10);
+  auto results = dpt_.existential_batched<dpt::com::collective_communication>(
+    std::move(queries), 4);
+  for (const auto& result : results) {
+    ASSERT_EQ(dpt::tree::search_state::MATCH, result);
+  }
+}
+
+TEST_F(dpt_test, batched_without_threads) {
+  // Zero threads are treated like a single thread.
+  q_list queries = gen_random_existing_queries(2000, 10);
+  auto q_checker = queries;
+  auto q_counting = queries;
+  auto results = dpt_.existential_batched<dpt::com::collective_communication>(
+    std::move(queries), 0);
+  auto counts = dpt_.counting_batched<dpt::com::collective_communication>(
+    std::move(q_counting), 0);
+  ASSERT_EQ(q_checker.size(), results.size());
+  ASSERT_EQ(q_checker.size(), counts.size());
+  for (size_t i = 0; i < q_checker.size(); ++i) {
+    ASSERT_EQ(dpt::tree::search_state::MATCH, results[i]);
+    ASSERT_EQ(occurrences(q_checker[i]), counts[i]);
+  }
+}
+
+TEST_F(dpt_test, save_and_load) {
+  ASSERT_TRUE(dpt_.save("test_data/dpt_test_index"));
+  dp_trie dpt_loaded;
+  ASSERT_TRUE(dpt_loaded.load("test_data/dpt_test_index"));
+  std::remove(("test_data/dpt_test_index." +
+    std::to_string(dpt::mpi::environment().rank())).c_str());
+
+  q_list queries = gen_random_existing_queries(2000, 10);
+  auto results =
+    dpt_loaded.existential_batched<dpt::com::collective_communication>(
+    std::move(queries));
+  for (const auto& result : results) {
+    ASSERT_EQ(dpt::tree::search_state::MATCH, result);
+  }
+  ASSERT_FALSE(dpt_loaded.load("test_data/non_existing_index"));
+}
+
+TEST_F(dpt_test, save_and_load_split_nodes) {
+  using split_trie = dpt::tree::distributed_patricia_trie<char, size_t, size_t,
+    dpt::tree::compact_trie_pointer_split,
+    dpt::tree::patricia_trie_pointer_split>;
+  split_trie dpt_split("test_data/the_three_brothers.txt",
+    "test_data/the_three_brothers_size_t_sa",
+    "test_data/the_three_brothers_size_t_lcp", 335);
+  dpt_split.construct<dpt::com::collective_communication,
+    dpt::com::collective_communication>();
+  ASSERT_TRUE(dpt_split.save("test_data/dpt_test_split_index"));
+  split_trie dpt_loaded;
+  ASSERT_TRUE(dpt_loaded.load("test_data/dpt_test_split_index"));
+  std::remove(("test_data/dpt_test_split_index." +
+    std::to_string(dpt::mpi::environment().rank())).c_str());
+
+  q_list queries = gen_random_existing_queries(2000, 10);
+  auto q_checker = queries;
+  auto results = dpt_loaded.counting_batched<
+    dpt::com::collective_communication>(std::move(queries));
+  for (size_t i = 0; i < results.size(); ++i) {
+    ASSERT_EQ(occurrences(q_checker[i]), results[i]);
+  }
+}
+
+TEST_F(dpt_test, counting_batched_existing) {
+  q_list queries = gen_random_existing_queries(2000, 10);
+  auto q_checker = queries;
+  auto results = dpt_.counting_batched<dpt::com::collective_communication>(
+    std::move(queries));
+  ASSERT_EQ(q_checker.size(), results.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    ASSERT_EQ(occurrences(q_checker[i]), results[i]);
+  }
+}
+
+TEST_F(dpt_test, counting_batched_frequent) {
+  std::vector<char> queries_txt = { 'e', ' ', 't', 'h', 'e', 'x' };
+  std::vector<size_t> query_lengths = { 1, 1, 3, 1 };
+  q_list queries(std::move(queries_txt), std::move(query_lengths));
+  auto q_checker = queries;
+  auto results = dpt_.counting_batched<dpt::com::collective_communication>(
+    std::move(queries));
+  ASSERT_EQ(q_checker.size(), results.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    ASSERT_EQ(occurrences(q_checker[i]), results[i]);
+  }
+}
+
+TEST_F(dpt_test, enumeration_batched_existing) {
+  q_list queries = gen_random_existing_queries(2000, 10);
+  auto q_checker = queries;
+  auto results = dpt_.enumeration_batched<dpt::com::collective_communication>(
+    std::move(queries));
+  ASSERT_EQ(q_checker.size(), results.second.size());
+  for (size_t i = 0, pos = 0; i < q_checker.size(); ++i) {
+    std::vector<size_t> found(results.first.begin() + pos,
+      results.first.begin() + pos + results.second[i]);
+    pos += results.second[i];
+    std::sort(found.begin(), found.end());
+    ASSERT_EQ(occurrence_positions(q_checker[i]), found);
+  }
+}
+
+TEST_F(dpt_test, enumeration_batched_frequent) {
+  std::vector<char> queries_txt = { 'e', ' ', 't', 'h', 'e', 'x' };
+  std::vector<size_t> query_lengths = { 1, 1, 3, 1 };
+  q_list queries(std::move(queries_txt), std::move(query_lengths));
+  auto q_checker = queries;
+  auto results = dpt_.enumeration_batched<dpt::com::collective_communication>(
+    std::move(queries));
+  for (size_t i = 0, pos = 0; i < q_checker.size(); ++i) {
+    std::vector<size_t> found(results.first.begin() + pos,
+      results.first.begin() + pos + results.second[i]);
+    pos += results.second[i];
+    std::sort(found.begin(), found.end());
+    ASSERT_EQ(occurrence_positions(q_checker[i]), found);
+  }
+}
+
+TEST_F(dpt_test, enumeration_batched_limit) {
+  std::vector<char> queries_txt = { 'e', ' ', 't', 'h', 'e', 'x', 'h', 'e' };
+  std::vector<size_t> query_lengths = { 1, 1, 3, 1, 2 };
+  q_list queries(std::move(queries_txt), std::move(query_lengths));
+  auto q_limited = queries;
+  auto all = dpt_.enumeration_batched<dpt::com::collective_communication>(
+    std::move(queries));
+  for (const size_t limit : { 0, 1, 7, 100, 1000 }) {
+    auto q_copy = q_limited;
+    auto results = dpt_.enumeration_batched<
+      dpt::com::collective_communication>(std::move(q_copy), 1, limit);
+    for (size_t i = 0, pos = 0, all_pos = 0; i < q_limited.size(); ++i) {
+      ASSERT_EQ(std::min(limit, all.second[i]), results.second[i]);
+      ASSERT_TRUE(std::equal(results.first.begin() + pos,
+        results.first.begin() + pos + results.second[i],
+        all.first.begin() + all_pos));
+      pos += results.second[i];
+      all_pos += all.second[i];
+    }
+  }
+}
+
+TEST_F(dpt_test, enumeration_batched_limit_characters) {
+  // The occurrences of single characters span several PEs, i.e., the PEs in
+  // between have to provide (parts of) their slices of the suffix array.
+  std::vector<char> queries_txt;
+  for (const char c : global_text_) {
+    if (std::find(queries_txt.begin(), queries_txt.end(), c) ==
+      queries_txt.end()) {
+      queries_txt.emplace_back(c);
+    }
+  }
+  std::vector<size_t> query_lengths(queries_txt.size(), 1);
+  q_list queries(std::move(queries_txt), std::move(query_lengths));
+  for (const size_t limit : { 1, 50, 129, 300, 500, 700, 5000 }) {
+    auto q_copy = queries;
+    auto results = dpt_.enumeration_batched<
+      dpt::com::collective_communication>(std::move(q_copy), 1, limit);
+    for (size_t i = 0, pos = 0; i < queries.size(); ++i) {
+      const auto positions = occurrence_positions(queries[i]);
+      ASSERT_EQ(std::min(limit, positions.size()), results.second[i]);
+      for (size_t j = 0; j < results.second[i]; ++j, ++pos) {
+        ASSERT_TRUE(std::binary_search(positions.begin(), positions.end(),
+          results.first[pos]));
+      }
+    }
+  }
+}
+
+TEST_F(dpt_test, batched_duplicates) {
+  // Short queries, i.e., most queries are contained several times.
+  q_list queries = gen_random_existing_queries(2000, 2);
+  auto q_checker = queries;
+  auto q_enumeration = queries;
+  auto counts = dpt_.counting_batched<dpt::com::collective_communication>(
+    std::move(queries));
+  auto results = dpt_.enumeration_batched<dpt::com::collective_communication>(
+    std::move(q_enumeration));
+  ASSERT_EQ(q_checker.size(), counts.size());
+  ASSERT_EQ(q_checker.size(), results.second.size());
+  for (size_t i = 0, pos = 0; i < q_checker.size(); ++i) {
+    ASSERT_EQ(occurrences(q_checker[i]), counts[i]);
+    std::vector<size_t> found(results.first.begin() + pos,
+      results.first.begin() + pos + results.second[i]);
+    pos += results.second[i];
+    std::sort(found.begin(), found.end());
+    ASSERT_EQ(occurrence_positions(q_checker[i]), found);
+  }
+}
+
+TEST_F(dpt_test, batched_cached) {
+  ASSERT_TRUE(dpt_.save("test_data/dpt_test_cache_index"));
+  dpt_.set_cache_capacity(100);
+  q_list queries = gen_random_existing_queries(200, 10);
+  for (size_t round = 0; round < 3; ++round) {
+    auto q_checker = queries;
+    auto q_existential = queries;
+    auto q_counting = queries;
+    auto states = dpt_.existential_batched<
+      dpt::com::collective_communication>(std::move(q_existential));
+    auto counts = dpt_.counting_batched<dpt::com::collective_communication>(
+      std::move(q_counting));
+    for (size_t i = 0; i < q_checker.size(); ++i) {
+      ASSERT_EQ(dpt::tree::search_state::MATCH, states[i]);
+      ASSERT_EQ(occurrences(q_checker[i]), counts[i]);
+    }
+  }
+  // Only the first round can miss all (distinct) queries.
+  ASSERT_GT(dpt_.existential_cache().hits(), uint64_t(0));
+  ASSERT_GT(dpt_.counting_cache().hits(), uint64_t(0));
+  ASSERT_LE(dpt_.counting_cache().size(), size_t(100));
+  // The cached results belong to the previous index.
+  ASSERT_TRUE(dpt_.load("test_data/dpt_test_cache_index"));
+  std::remove(("test_data/dpt_test_cache_index." +
+    std::to_string(dpt::mpi::environment().rank())).c_str());
+  ASSERT_EQ(size_t(0), dpt_.existential_cache().size());
+  ASSERT_EQ(size_t(0), dpt_.counting_cache().size());
+}
+
+// Builds the trie of \e text (written to a temporary file) and compares the
+// results of counting queries of length at most \e max_length with the
+// number of occurrences in \e text.
+template <typename Alphabet>
+void check_counting(const std::vector<Alphabet>& text,
+  const size_t max_length) {
+  using alphabet_trie = dpt::tree::distributed_patricia_trie<Alphabet, size_t,
+    size_t, dpt::tree::compact_trie_pointer, dpt::tree::patricia_trie_pointer>;
+  dpt::mpi::environment env;
+  const std::string text_path = "test_data/dpt_test_alphabet";
+  if (env.rank() == 0) {
+    std::ofstream stream(text_path, std::ios::binary);
+    stream.write(reinterpret_cast<const char*>(text.data()),
+      text.size() * sizeof(Alphabet));
+  }
+  env.barrier();
+  alphabet_trie trie(text_path, 20);
+  trie.template construct<dpt::com::collective_communication,
+    dpt::com::collective_communication>();
+  env.barrier();
+  if (env.rank() == 0) {
+    std::remove(text_path.c_str());
+  }
+
+  std::srand(44227);
+  std::vector<Alphabet> queries;
+  std::vector<size_t> query_lengths;
+  for (size_t i = 0; i < 1000; ++i) {
+    const size_t query_length = (std::rand() % max_length) + 1;
+    const size_t query_pos = std::rand() % (text.size() - query_length);
+    std::copy_n(text.begin() + query_pos, query_length,
+      std::back_inserter(queries));
+    query_lengths.emplace_back(query_length);
+  }
+  dpt::query::query_list<Alphabet, size_t, size_t> q_list(std::move(queries),
+    std::move(query_lengths));
+  auto q_checker = q_list;
+  auto results = trie.template counting_batched<
+    dpt::com::collective_communication>(std::move(q_list));
+  ASSERT_EQ(q_checker.size(), results.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    size_t nr_occurrences = 0;
+    for (auto it = text.begin(); (it = std::search(it, text.end(),
+      q_checker[i].query, q_checker[i].query + q_checker[i].length)) !=
+      text.end(); ++it) {
+      ++nr_occurrences;
+    }
+    ASSERT_EQ(nr_occurrences, results[i]);
+  }
+}
+
+TEST_F(dpt_test, full_byte_alphabet) {
+  // All 256 characters occur, i.e., the roots of the tries have 256 children.
+  std::vector<uint8_t> text;
+  std::srand(44227);
+  for (size_t i = 0; i < 16384; ++i) {
+    text.emplace_back((i < 256) ? i : std::rand() % 256);
+  }
+  check_counting(text, 3);
+}
+
+TEST_F(dpt_test, word_alphabet) {
+  // Each word of the text is replaced by a 32-bit ID, i.e., the queries are
+  // phrases.
+  std::vector<uint32_t> words;
+  std::map<std::string, uint32_t> ids;
+  std::istringstream stream(global_text_);
+  for (std::string word; stream >> word;) {
+    words.emplace_back(ids.emplace(word, ids.size() + 1).first->second);
+  }
+  ASSERT_GT(ids.size(), size_t(256));
+  check_counting(words, 4);
+}
 
 /******************************************************************************/
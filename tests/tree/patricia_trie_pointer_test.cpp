@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include <fstream>
+#include <limits>
 #include <gtest/gtest.h>
 #include <memory>
 #include <stdlib.h>
@@ -85,6 +86,42 @@ public:
     return q_list(std::move(queries), std::move(query_lengths));
   }
 
+  // Builds a trie of type Trie (sequentially and in parallel) and checks
+  // that it answers all types of queries like pt_.
+  template <typename Trie>
+  void check_same_results() {
+    for (const size_t nr_threads : { 1, 4 }) {
+      Trie other_pt;
+      other_pt.template construct<dpt::com::collective_communication>(
+        part_sa_, part_lcp_, manager_, 300, nr_threads);
+      q_list queries = gen_random_existing_queries(2000, 10);
+      auto ex_queries = queries;
+      auto ex_queries_other = queries;
+      auto co_queries = queries;
+      auto co_queries_other = queries;
+      auto en_queries = queries;
+      auto en_queries_other = queries;
+      ASSERT_EQ(
+        pt_.existential_batched<dpt::com::collective_communication>(
+          std::move(ex_queries), manager_, part_sa_),
+        other_pt.template existential_batched<
+          dpt::com::collective_communication>(
+          std::move(ex_queries_other), manager_, part_sa_));
+      ASSERT_EQ(
+        pt_.counting_batched<dpt::com::collective_communication>(
+          std::move(co_queries), manager_, part_sa_),
+        other_pt.template counting_batched<
+          dpt::com::collective_communication>(
+          std::move(co_queries_other), manager_, part_sa_));
+      ASSERT_EQ(
+        pt_.enumeration_batched<dpt::com::collective_communication>(
+          std::move(en_queries), manager_, part_sa_),
+        other_pt.template enumeration_batched<
+          dpt::com::collective_communication>(
+          std::move(en_queries_other), manager_, part_sa_));
+    }
+  }
+
 public:
   dpt::mpi::environment env_;
   pat_trie pt_;
@@ -216,4 +253,90 @@ TEST_F(patricia_trie_pointer_test, enumeration_batched_non_existing) {
   }
 }
 
+TEST_F(patricia_trie_pointer_test, parallel_construction) {
+  for (const size_t nr_threads : { 2, 3, 4, 16 }) {
+    pat_trie parallel_pt;
+    if (env_.size() == 1) {
+      parallel_pt.template construct<dpt::com::local_communication>(
+        part_sa_, part_lcp_, manager_, 300, nr_threads);
+    } else {
+      parallel_pt.template construct<dpt::com::collective_communication>(
+        part_sa_, part_lcp_, manager_, 300, nr_threads);
+    }
+    ASSERT_EQ(pt_.number_of_nodes(), parallel_pt.number_of_nodes());
+    ASSERT_EQ(pt_.global_sa_and_lcp(), parallel_pt.global_sa_and_lcp());
+    ASSERT_EQ(pt_.root().string_depth, parallel_pt.root().string_depth);
+    ASSERT_EQ(pt_.root().out_degree, parallel_pt.root().out_degree);
+    ASSERT_EQ(pt_.root().edge_begin, parallel_pt.root().edge_begin);
+    for (size_t i = 0; i < pt_.number_of_nodes(); ++i) {
+      ASSERT_EQ(pt_.get_node(i).string_depth,
+        parallel_pt.get_node(i).string_depth);
+      ASSERT_EQ(pt_.get_node(i).out_degree, parallel_pt.get_node(i).out_degree);
+      ASSERT_EQ(pt_.get_node(i).edge_begin, parallel_pt.get_node(i).edge_begin);
+      ASSERT_EQ(pt_.get_label(i), parallel_pt.get_label(i));
+    }
+  }
+}
+
+TEST_F(patricia_trie_pointer_test, batched_queries_with_threads) {
+  q_list queries = gen_random_existing_queries(2000, 10);
+  auto ex_queries = queries;
+  auto ex_queries_threads = queries;
+  auto co_queries = queries;
+  auto co_queries_threads = queries;
+  auto en_queries = queries;
+  auto en_queries_threads = queries;
+  ASSERT_EQ(
+    pt_.existential_batched<dpt::com::collective_communication>(
+      std::move(ex_queries), manager_, part_sa_),
+    pt_.existential_batched<dpt::com::collective_communication>(
+      std::move(ex_queries_threads), manager_, part_sa_, 4));
+  ASSERT_EQ(
+    pt_.counting_batched<dpt::com::collective_communication>(
+      std::move(co_queries), manager_, part_sa_),
+    pt_.counting_batched<dpt::com::collective_communication>(
+      std::move(co_queries_threads), manager_, part_sa_, 4));
+  ASSERT_EQ(
+    pt_.enumeration_batched<dpt::com::collective_communication>(
+      std::move(en_queries), manager_, part_sa_),
+    pt_.enumeration_batched<dpt::com::collective_communication>(
+      std::move(en_queries_threads), manager_, part_sa_, 4));
+}
+
+TEST_F(patricia_trie_pointer_test, leaf_ranges) {
+  check_same_results<dpt::tree::patricia_trie_pointer_leaf_ranges<char, size_t,
+    size_t>>();
+}
+
+TEST_F(patricia_trie_pointer_test, split_nodes) {
+  check_same_results<dpt::tree::patricia_trie_pointer_split<char, size_t,
+    size_t>>();
+  check_same_results<dpt::tree::patricia_trie_pointer<char, size_t, size_t,
+    true, dpt::tree::split_nodes>>();
+}
+
+TEST_F(patricia_trie_pointer_test, relayout) {
+  q_list queries = gen_random_existing_queries(2000, 10);
+  for (const size_t block_size : { size_t(1), size_t(7),
+    std::numeric_limits<size_t>::max() }) {
+    pat_trie relayouted_pt = pt_;
+    relayouted_pt.relayout(block_size);
+    ASSERT_EQ(pt_.number_of_nodes(), relayouted_pt.number_of_nodes());
+    auto co_queries = queries;
+    auto co_queries_relayouted = queries;
+    auto en_queries = queries;
+    auto en_queries_relayouted = queries;
+    ASSERT_EQ(
+      pt_.counting_batched<dpt::com::collective_communication>(
+        std::move(co_queries), manager_, part_sa_),
+      relayouted_pt.counting_batched<dpt::com::collective_communication>(
+        std::move(co_queries_relayouted), manager_, part_sa_));
+    ASSERT_EQ(
+      pt_.enumeration_batched<dpt::com::collective_communication>(
+        std::move(en_queries), manager_, part_sa_),
+      relayouted_pt.enumeration_batched<dpt::com::collective_communication>(
+        std::move(en_queries_relayouted), manager_, part_sa_));
+  }
+}
+
 /******************************************************************************/
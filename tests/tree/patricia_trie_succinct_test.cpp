@@ -0,0 +1,148 @@
+/*******************************************************************************
+ * tests/tree/patricia_trie_succinct_test.cpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "com/collective.hpp"
+#include "com/manager.hpp"
+#include "mpi/environment.hpp"
+#include "mpi/io.hpp"
+#include "query/query_list.hpp"
+#include "tree/patricia_trie_pointer.hpp"
+#include "tree/patricia_trie_succinct.hpp"
+#include "tree/search_result.hpp"
+
+using char_partition = dpt::util::partition<char, size_t, size_t>;
+using manager = dpt::com::manager<char, size_t, size_t>;
+using pointer_trie = dpt::tree::patricia_trie_pointer<char, size_t, size_t>;
+using succinct_trie = dpt::tree::patricia_trie_succinct<char, size_t, size_t>;
+using q_list = dpt::query::query_list<char, size_t, size_t>;
+using size_t_partition = dpt::util::partition<size_t, size_t, size_t>;
+
+class patricia_trie_succinct_test : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    local_text_ = dpt::mpi::distribute_file<char, size_t, size_t>(
+        "test_data/the_three_brothers.txt", 40);
+    auto tmp_text = local_text_;
+    manager_ = manager(std::move(tmp_text));
+    part_sa_ =
+      dpt::mpi::distribute_file<size_t, size_t, size_t>(
+        "test_data/the_three_brothers_size_t_sa", 0);
+    part_lcp_ =
+      dpt::mpi::distribute_file<size_t, size_t, size_t>(
+        "test_data/the_three_brothers_size_t_lcp", 0);
+
+    std::ifstream stream("test_data/the_three_brothers.txt", std::ios::in);
+    stream.seekg(0, std::ios::end);
+    uint64_t size = stream.tellg();
+    stream.seekg(0);
+    std::vector<char> text(size);
+    stream.read(reinterpret_cast<char*>(text.data()), size);
+    global_text_ = std::string(text.begin(), text.end());
+
+    pt_.template construct<dpt::com::collective_communication>(
+      part_sa_, part_lcp_, manager_, 300);
+    st_.template construct<dpt::com::collective_communication>(
+      part_sa_, part_lcp_, manager_, 300);
+  }
+
+  virtual void TearDown() { }
+
+public:
+  // Queries that occur in the text (their first characters) and queries that
+  // are made up of random characters.
+  q_list gen_random_queries(const size_t nr_queries, const size_t max_length) {
+    std::srand(44227);
+    std::vector<char> queries;
+    std::vector<size_t> query_lengths;
+    for (size_t i = 0; i < nr_queries; ++i) {
+      size_t query_length = (std::rand() % max_length) + 1;
+      if (i % 2 == 0) {
+        const auto query_pos = std::rand() % global_text_.size();
+        if (query_pos + query_length >= global_text_.size()) {
+          query_length = global_text_.size() - query_pos;
+        }
+        std::copy_n(global_text_.begin() + query_pos, query_length,
+          std::back_inserter(queries));
+      } else {
+        for (size_t j = 0; j < query_length; ++j) {
+          queries.emplace_back(char('a' + std::rand() % 4));
+        }
+      }
+      query_lengths.emplace_back(query_length);
+    }
+    return q_list(std::move(queries), std::move(query_lengths));
+  }
+
+public:
+  dpt::mpi::environment env_;
+  pointer_trie pt_;
+  succinct_trie st_;
+  manager manager_;
+  char_partition local_text_;
+  size_t_partition part_sa_;
+  size_t_partition part_lcp_;
+  std::string global_text_;
+}; // class patricia_trie_succinct_test
+
+TEST_F(patricia_trie_succinct_test, construction) {
+  ASSERT_EQ(pt_.number_of_nodes() + 1, st_.number_of_nodes());
+  ASSERT_EQ(pt_.global_sa_and_lcp(), st_.global_sa_and_lcp());
+}
+
+TEST_F(patricia_trie_succinct_test, batched_queries) {
+  q_list queries = gen_random_queries(2000, 10);
+  for (const size_t nr_threads : { 1, 4 }) {
+    auto pt_queries = queries;
+    auto st_queries = queries;
+    ASSERT_EQ(
+      pt_.existential_batched<dpt::com::collective_communication>(
+        std::move(pt_queries), manager_, part_sa_),
+      st_.existential_batched<dpt::com::collective_communication>(
+        std::move(st_queries), manager_, part_sa_, nr_threads));
+    pt_queries = queries;
+    st_queries = queries;
+    ASSERT_EQ(
+      pt_.counting_batched<dpt::com::collective_communication>(
+        std::move(pt_queries), manager_, part_sa_),
+      st_.counting_batched<dpt::com::collective_communication>(
+        std::move(st_queries), manager_, part_sa_, nr_threads));
+    pt_queries = queries;
+    st_queries = queries;
+    ASSERT_EQ(
+      pt_.enumeration_batched<dpt::com::collective_communication>(
+        std::move(pt_queries), manager_, part_sa_, 1, 5),
+      st_.enumeration_batched<dpt::com::collective_communication>(
+        std::move(st_queries), manager_, part_sa_, nr_threads, 5));
+  }
+}
+
+TEST_F(patricia_trie_succinct_test, copy) {
+  q_list queries = gen_random_queries(500, 10);
+  auto copy_queries = queries;
+  auto move_queries = queries;
+  succinct_trie copy = st_;
+  const auto expected =
+    st_.counting_batched<dpt::com::collective_communication>(
+      std::move(queries), manager_, part_sa_);
+  ASSERT_EQ(expected,
+    copy.counting_batched<dpt::com::collective_communication>(
+      std::move(copy_queries), manager_, part_sa_));
+  succinct_trie moved = std::move(copy);
+  ASSERT_EQ(expected,
+    moved.counting_batched<dpt::com::collective_communication>(
+      std::move(move_queries), manager_, part_sa_));
+}
+
+/******************************************************************************/
@@ -0,0 +1,81 @@
+/*******************************************************************************
+ * tests/util/lru_cache_test.cpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include <dpt/util/lru_cache.hpp>
+
+TEST(lru_cache, find_and_insert) {
+  dpt::util::lru_cache<size_t> cache(4);
+  for (size_t i = 0; i < 4; ++i) {
+    ASSERT_EQ(nullptr, cache.find(std::to_string(i)));
+    cache.insert(std::to_string(i), i);
+  }
+  ASSERT_EQ(size_t(4), cache.size());
+  for (size_t i = 0; i < 4; ++i) {
+    const size_t* value = cache.find(std::to_string(i));
+    ASSERT_NE(nullptr, value);
+    ASSERT_EQ(i, *value);
+  }
+  cache.insert("2", 42);
+  ASSERT_EQ(size_t(4), cache.size());
+  ASSERT_EQ(size_t(42), *cache.find("2"));
+  ASSERT_EQ(uint64_t(5), cache.hits());
+  ASSERT_EQ(uint64_t(4), cache.misses());
+  cache.reset_statistics();
+  ASSERT_EQ(uint64_t(0), cache.hits());
+  ASSERT_EQ(uint64_t(0), cache.misses());
+}
+
+TEST(lru_cache, eviction) {
+  dpt::util::lru_cache<size_t> cache(3);
+  cache.insert("a", 0);
+  cache.insert("b", 1);
+  cache.insert("c", 2);
+  // "a" becomes the most recently used entry, hence "b" is evicted.
+  ASSERT_NE(nullptr, cache.find("a"));
+  cache.insert("d", 3);
+  ASSERT_EQ(size_t(3), cache.size());
+  ASSERT_EQ(nullptr, cache.find("b"));
+  ASSERT_NE(nullptr, cache.find("a"));
+  ASSERT_NE(nullptr, cache.find("c"));
+  ASSERT_NE(nullptr, cache.find("d"));
+
+  // The least recently used entry is "a".
+  cache.resize(2);
+  ASSERT_EQ(size_t(2), cache.size());
+  ASSERT_EQ(nullptr, cache.find("a"));
+  ASSERT_NE(nullptr, cache.find("c"));
+  ASSERT_NE(nullptr, cache.find("d"));
+}
+
+TEST(lru_cache, clear) {
+  dpt::util::lru_cache<size_t> cache(3);
+  cache.insert("a", 0);
+  cache.insert("b", 1);
+  cache.clear();
+  ASSERT_EQ(size_t(0), cache.size());
+  ASSERT_EQ(size_t(3), cache.capacity());
+  ASSERT_EQ(nullptr, cache.find("a"));
+  cache.insert("a", 2);
+  ASSERT_EQ(size_t(2), *cache.find("a"));
+}
+
+TEST(lru_cache, disabled) {
+  dpt::util::lru_cache<size_t> cache;
+  cache.insert("a", 0);
+  ASSERT_EQ(size_t(0), cache.size());
+  ASSERT_EQ(nullptr, cache.find("a"));
+  ASSERT_EQ(uint64_t(0), cache.hits());
+  ASSERT_EQ(uint64_t(0), cache.misses());
+}
+
+/******************************************************************************/
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * tests/util/serialization_test.cpp
+ *
+ * Part of dpt - Distributed Patricia Trie
+ *
+ * Copyright (C) 2017 Florian Kurpicz <florian.kurpicz@tu-dortmund.de>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <cstdint>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include <dpt/util/mapped_vector.hpp>
+#include <dpt/util/serialization.hpp>
+
+TEST(serialization, mapped_arrays) {
+  const std::string file_name = "test_data/serialization_test_index";
+  // The odd number of characters misaligns the following array (if it was
+  // not padded).
+  const std::vector<char> characters = { 'a', 'b', 'c' };
+  const std::vector<uint64_t> numbers = { 4, 2, 42, 4242 };
+  {
+    dpt::util::index_writer writer(file_name);
+    writer.write(uint32_t(7));
+    writer.write(characters);
+    writer.write(dpt::util::mapped_vector<uint64_t>(
+      std::vector<uint64_t>(numbers)));
+    writer.write(numbers);
+    ASSERT_TRUE(writer.good());
+  }
+
+  dpt::util::mapped_vector<char> mapped_characters;
+  dpt::util::mapped_vector<uint64_t> mapped_numbers;
+  std::vector<uint64_t> copied_numbers;
+  {
+    uint32_t value = 0;
+    dpt::util::index_reader reader(file_name);
+    ASSERT_TRUE(reader.read(value));
+    ASSERT_EQ(uint32_t(7), value);
+    ASSERT_TRUE(reader.read(mapped_characters));
+    ASSERT_TRUE(reader.read(mapped_numbers));
+    ASSERT_TRUE(reader.read(copied_numbers));
+    ASSERT_TRUE(reader.finished());
+    ASSERT_FALSE(reader.read(value));
+  }
+  std::remove(file_name.c_str());
+
+  // The views keep the file mapped after the reader has been destroyed.
+  ASSERT_TRUE(mapped_characters.is_mapped());
+  ASSERT_TRUE(mapped_numbers.is_mapped());
+  ASSERT_EQ(uintptr_t(0),
+    reinterpret_cast<uintptr_t>(mapped_numbers.data()) % alignof(uint64_t));
+  ASSERT_EQ(characters, std::vector<char>(mapped_characters.begin(),
+    mapped_characters.end()));
+  ASSERT_EQ(numbers, std::vector<uint64_t>(mapped_numbers.begin(),
+    mapped_numbers.end()));
+  ASSERT_EQ(numbers, copied_numbers);
+
+  // Changing a view copies it first.
+  mapped_numbers.vector()[0] = 5;
+  ASSERT_FALSE(mapped_numbers.is_mapped());
+  ASSERT_EQ(uint64_t(5), mapped_numbers[0]);
+  ASSERT_EQ(numbers.size(), mapped_numbers.size());
+}
+
+TEST(serialization, invalid_files) {
+  dpt::util::mapped_vector<uint64_t> data;
+  dpt::util::index_reader missing("test_data/serialization_test_missing");
+  ASSERT_FALSE(missing.good());
+  ASSERT_FALSE(missing.read(data));
+
+  // The stored size exceeds the file.
+  const std::string file_name = "test_data/serialization_test_truncated";
+  {
+    dpt::util::index_writer writer(file_name);
+    writer.write(uint64_t(1000));
+    writer.write(uint64_t(0));
+  }
+  dpt::util::index_reader truncated(file_name);
+  ASSERT_TRUE(truncated.good());
+  ASSERT_FALSE(truncated.read(data));
+  ASSERT_FALSE(truncated.good());
+  std::remove(file_name.c_str());
+}
+
+/******************************************************************************/